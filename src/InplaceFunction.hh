@@ -0,0 +1,222 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+template <typename Signature, size_t Capacity = 4 * sizeof(void *)>
+class InplaceFunction;
+
+/*
+Move-only replacement for std::function with a configurable inline buffer.
+- callables up to `Capacity` bytes (pointer-aligned, nothrow movable) are stored
+  inside the object: no allocation, unlike std::function past ~16 bytes
+- bigger callables still work, they are moved to the heap
+- move-only callables are accepted (unique_ptr captures, promises, Tasks...)
+- operator() is const like std::function's, and throws std::bad_function_call
+  when empty
+- the object itself is not copyable, but a copyable callable can still be
+  duplicated explicitly through copy()
+*/
+template <typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity>
+{
+public:
+    InplaceFunction() noexcept = default;
+    InplaceFunction(std::nullptr_t) noexcept {}
+
+    template <typename F, typename Fn = std::decay_t<F>,
+              typename = std::enable_if_t<!std::is_same_v<Fn, InplaceFunction> &&
+                                          std::is_invocable_r_v<R, Fn &, Args...>>>
+    InplaceFunction(F &&fn)
+    {
+        if constexpr (std::is_pointer_v<Fn> || std::is_member_pointer_v<Fn> || IsStdFunction<Fn>::value)
+        {
+            if (!fn)
+                return; // Empty stays empty, as with std::function
+        }
+
+        if constexpr (fitsInline<Fn>())
+        {
+            ::new (static_cast<void *>(buffer)) Fn(std::forward<F>(fn));
+            ops = &inlineOps<Fn>;
+        }
+        else
+        {
+            ::new (static_cast<void *>(buffer)) Fn *(new Fn(std::forward<F>(fn)));
+            ops = &heapOps<Fn>;
+        }
+    }
+
+    InplaceFunction(InplaceFunction &&other) noexcept
+    {
+        moveFrom(other);
+    }
+
+    InplaceFunction &operator=(InplaceFunction &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            moveFrom(other);
+        }
+
+        return *this;
+    }
+
+    InplaceFunction &operator=(std::nullptr_t) noexcept
+    {
+        reset();
+        return *this;
+    }
+
+    template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InplaceFunction>>>
+    InplaceFunction &operator=(F &&fn)
+    {
+        InplaceFunction(std::forward<F>(fn)).swap(*this);
+        return *this;
+    }
+
+    InplaceFunction(const InplaceFunction &) = delete;
+    InplaceFunction &operator=(const InplaceFunction &) = delete;
+
+    ~InplaceFunction() { reset(); }
+
+    R operator()(Args... args) const
+    {
+        if (!ops)
+            throw std::bad_function_call();
+
+        return ops->invoke(buffer, std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept { return ops != nullptr; }
+
+    // Whether the stored callable is copy constructible (empty counts as copyable)
+    bool copyable() const noexcept { return !ops || ops->copy; }
+
+    // Independent copy of the stored callable; throws std::logic_error for a move-only one
+    InplaceFunction copy() const
+    {
+        InplaceFunction result;
+        if (!ops)
+            return result;
+
+        if (!ops->copy)
+            throw std::logic_error("InplaceFunction: the stored callable is move-only");
+
+        ops->copy(buffer, result.buffer);
+        result.ops = ops;
+        return result;
+    }
+
+    friend bool operator==(const InplaceFunction &f, std::nullptr_t) noexcept { return !f; }
+
+    void swap(InplaceFunction &other) noexcept
+    {
+        InplaceFunction tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    // Whether a callable of type F is stored without allocating
+    template <typename F>
+    static constexpr bool fitsInline()
+    {
+        return sizeof(F) <= Capacity && alignof(F) <= alignof(void *) &&
+               std::is_nothrow_move_constructible_v<F>;
+    }
+
+private:
+    struct Ops
+    {
+        R (*invoke)(void *storage, Args &&...args);
+        void (*move)(void *from, void *to) noexcept; // Move-construct into `to`, then destroy `from`
+        void (*destroy)(void *storage) noexcept;
+        void (*copy)(const void *from, void *to); // Copy-construct into `to`; null for move-only callables
+    };
+
+    template <typename T>
+    struct IsStdFunction : std::false_type
+    {
+    };
+
+    template <typename Sig>
+    struct IsStdFunction<std::function<Sig>> : std::true_type
+    {
+    };
+
+    using CopyOp = void (*)(const void *from, void *to);
+
+    template <typename Fn>
+    static constexpr CopyOp inlineCopy()
+    {
+        if constexpr (std::is_copy_constructible_v<Fn>)
+            return [](const void *from, void *to)
+            { ::new (to) Fn(*static_cast<const Fn *>(from)); };
+        else
+            return nullptr;
+    }
+
+    template <typename Fn>
+    static constexpr CopyOp heapCopy()
+    {
+        if constexpr (std::is_copy_constructible_v<Fn>)
+            return [](const void *from, void *to)
+            { ::new (to) Fn *(new Fn(**static_cast<Fn *const *>(from))); };
+        else
+            return nullptr;
+    }
+
+    template <typename Fn>
+    static constexpr Ops inlineOps{
+        [](void *storage, Args &&...args) -> R
+        { return std::invoke(*static_cast<Fn *>(storage), std::forward<Args>(args)...); },
+        [](void *from, void *to) noexcept
+        {
+            ::new (to) Fn(std::move(*static_cast<Fn *>(from)));
+            static_cast<Fn *>(from)->~Fn();
+        },
+        [](void *storage) noexcept
+        { static_cast<Fn *>(storage)->~Fn(); },
+        inlineCopy<Fn>()};
+
+    template <typename Fn>
+    static constexpr Ops heapOps{
+        [](void *storage, Args &&...args) -> R
+        { return std::invoke(**static_cast<Fn **>(storage), std::forward<Args>(args)...); },
+        [](void *from, void *to) noexcept
+        { ::new (to) Fn *(*static_cast<Fn **>(from)); },
+        [](void *storage) noexcept
+        { delete *static_cast<Fn **>(storage); },
+        heapCopy<Fn>()};
+
+    static_assert(Capacity >= sizeof(void *), "InplaceFunction: the buffer must hold at least a pointer");
+
+    // Mutable: the stored callable may be stateful, and operator() is const
+    alignas(void *) mutable unsigned char buffer[Capacity];
+    const Ops *ops = nullptr;
+
+    void moveFrom(InplaceFunction &other) noexcept
+    {
+        if (other.ops)
+        {
+            other.ops->move(other.buffer, buffer);
+            ops = std::exchange(other.ops, nullptr);
+        }
+    }
+
+    void reset() noexcept
+    {
+        if (ops)
+            std::exchange(ops, nullptr)->destroy(buffer);
+    }
+};
+
+// Move-only function with the default inline buffer (four pointers)
+template <typename Signature>
+using UniqueFunction = InplaceFunction<Signature>;
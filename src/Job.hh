@@ -3,8 +3,12 @@
 #include <iostream>
 #include <functional>
 #include <exception>
+#include <memory>
+#include <stdexcept>
 #include <type_traits>
 
+#include "InplaceFunction.hh"
+#include "JobPool.hh"
 #include "JobResult.hh"
 #include "log_utils.h"
 
@@ -17,68 +21,99 @@ enum class JobStatus
     Timeout
 };
 
-struct Job
+/*
+Cold part of a Job: descriptive strings and callbacks, read when a job starts,
+fails or finishes but never while it sits in a queue.
+- allocated on first write (Job::editDetails), so a bare task carries none
+- jobs stamped from one JobBuilder share a single block: each callback is one
+  instance, called concurrently from every worker running one of those jobs,
+  so it must not keep state of its own (JobBuilder only takes const-callable
+  ones); state it updates lives outside, e.g. in atomics it refers to
+*/
+struct JobDetails
 {
     // Unique identifier for the job
     string id;
-    // Main execution function of the job
-    function<void()> tasks;
-    // Priority of the job (the larger the value, the higher the priority)
-    int priority = 0;
-    // Number of retries allowed if job fails
-    int retryCount = 0;
-    // Maximum time (in milliseconds) for a job run
-    int timeoutMs = 0;
 
-    // Current status of the job (Pending, Running, Succeeded, Failed, etc.)
-    atomic<JobStatus> status{JobStatus::Pending};
+    // Group/category of work, used for sorting or tracking (e.g. via ProgressTracker), interned
+    CategoryName category;
 
     // Callback is called when the job finishes (whether successful or failed)
     // - success: indicates whether the job was successful or not
     // - attempt: number of attempts to execute
     // - durationMs: running time (in milliseconds)
-    function<void(bool success, int attempt, long long durationMs)> onComplete = nullptr;
-
-    // Group/category of work, used for sorting or tracking (e.g. via ProgressTracker)
-    string category = "default";
+    UniqueFunction<void(bool success, int attempt, long long durationMs)> onComplete = nullptr;
 
     // Callback is called after each attempt to execute the job
     // - attempt: which attempt
     // - success: whether the job was successful in this attempt
     // - elapsed: execution time in the attempt (milliseconds)
     // - errorMsg: error message if any
-    function<void(int attempt, bool success, long long elapsed, string_view errorMsg)> onAttempt = nullptr;
+    UniqueFunction<void(int attempt, bool success, long long elapsed, string_view errorMsg)> onAttempt = nullptr;
 
     // Callback is called when the job completes (success or failure)
     // - JobResult contains detailed result information
-    function<void(const JobResult &)> onResult = nullptr;
+    UniqueFunction<void(const JobResult &)> onResult = nullptr;
 
     // Callback is called as soon as the job starts running
-    function<void()> onStart;
+    UniqueFunction<void()> onStart;
 
     // Callback is called if the job encounters an error during execution
     // - error: error information as a string
-    function<void(const string &error)> onError;
+    UniqueFunction<void(const string &error)> onError;
 
     // Callback is called if the job times out
-    function<void()> onTimeout;
+    UniqueFunction<void()> onTimeout;
+};
+
+/*
+Queue-resident part of a job: the task, a numeric id, scheduling settings and
+flags fit in two cache lines. Everything else lives in the JobDetails block.
+*/
+struct Job
+{
+    // Main execution function of the job. Move-only; captures up to six pointers are stored inline
+    InplaceFunction<void(), 6 * sizeof(void *)> tasks;
+    // Numeric id, e.g. the instance number of a job stamped from a JobBuilder template
+    uint64_t number = 0;
+    // Strings and callbacks; nullptr until one is set
+    shared_ptr<JobDetails> cold;
+    // Priority of the job (the larger the value, the higher the priority)
+    int priority = 0;
+    // Number of retries allowed if job fails
+    int retryCount = 0;
+    // Maximum time (in milliseconds) for a job run
+    int timeoutMs = 0;
+
+    // Current status of the job (Pending, Running, Succeeded, Failed, etc.)
+    atomic<JobStatus> status{JobStatus::Pending};
+
+    // Workers call tasks() directly, without JobExecutor's retries, callbacks or logging:
+    // fork-join strands (TaskGroup::spawn) and TypedJob nodes, which do their own
+    bool spawned = false;
+
+    // Link while the job waits on a Strand; belongs to the node, not moved with the job
+    Job *strandNext = nullptr;
+
+    // JobGroup the job was added to, nullptr otherwise; workers running a group's
+    // jobs back to back defer its bookkeeping (see Worker::defer)
+    const void *group = nullptr;
 
     Job() = default;
 
+    // Virtual so that a node derived from Job (see TypedJob::toJob) is destroyed and released whole
+    virtual ~Job() = default;
+
     // Move constructor: move resources from another Job (no copy)
-    Job(Job &&other) noexcept : id(std::move(other.id)),
-                                tasks(std::move(other.tasks)),
+    Job(Job &&other) noexcept : tasks(std::move(other.tasks)),
+                                number(other.number),
+                                cold(std::move(other.cold)),
                                 priority(other.priority),
                                 retryCount(other.retryCount),
                                 timeoutMs(other.timeoutMs),
                                 status(other.status.load()), // load atomic value
-                                onComplete(std::move(other.onComplete)),
-                                category(std::move(other.category)),
-                                onAttempt(std::move(other.onAttempt)),
-                                onResult(std::move(other.onResult)),
-                                onStart(std::move(other.onStart)),
-                                onError(std::move(other.onError)),
-                                onTimeout(std::move(other.onTimeout))
+                                spawned(other.spawned),
+                                group(other.group)
     {
         other.status = JobStatus::Pending; // reset the power side state if necessary
     }
@@ -88,19 +123,15 @@ struct Job
     {
         if (this != &other)
         {
-            id = std::move(other.id);
             tasks = std::move(other.tasks);
+            number = other.number;
+            cold = std::move(other.cold);
             priority = other.priority;
             retryCount = other.retryCount;
             timeoutMs = other.timeoutMs;
             status.store(other.status.load());
-            onComplete = std::move(other.onComplete);
-            category = std::move(other.category);
-            onAttempt = std::move(other.onAttempt);
-            onResult = std::move(other.onResult);
-            onStart = std::move(other.onStart);
-            onError = std::move(other.onError);
-            onTimeout = std::move(other.onTimeout);
+            spawned = other.spawned;
+            group = other.group;
 
             other.status = JobStatus::Pending;
         }
@@ -108,10 +139,46 @@ struct Job
         return *this;
     }
 
+    // Strings and callbacks for reading; defaults (no id, "default" category, no callbacks) when unset
+    const JobDetails &details() const
+    {
+        static const JobDetails none{};
+        return cold ? *cold : none;
+    }
+
+    /*
+    Strings and callbacks for writing, allocated on first use.
+    Throws logic_error when the block is shared with other jobs (or the
+    JobBuilder they came from): an edit would change all of them.
+    */
+    JobDetails &editDetails()
+    {
+        if (!cold)
+            cold = make_shared<JobDetails>();
+        else if (cold.use_count() > 1)
+            throw logic_error("Job details are shared with other jobs");
+
+        return *cold;
+    }
+
     // Delete copy ctor + copy assignment
     Job(const Job &) = delete;
     Job &operator=(const Job &) = delete;
 
+    // Heap jobs come from JobPool's slabs, derived nodes too up to JobPool::maxBlockSize (bigger ones from the global heap)
+    static void *operator new(size_t size)
+    {
+        return size <= JobPool::maxBlockSize(sizeof(Job)) ? JobPool::allocate(size) : ::operator new(size);
+    }
+
+    static void operator delete(void *ptr, size_t size) noexcept
+    {
+        if (size <= JobPool::maxBlockSize(sizeof(Job)))
+            JobPool::deallocate(ptr, size);
+        else
+            ::operator delete(ptr);
+    }
+
     // template <typename Callable>
     // Job(Callable &&fn) : tasks(std::forward<Callable>(fn)) {}
 
@@ -145,6 +212,8 @@ struct Job
     */
     bool execute()
     {
+        const JobDetails &d = details();
+
         // Mark the running job status
         status = JobStatus::Running;
 
@@ -166,8 +235,8 @@ struct Job
                 errorMsg = e.what();
 
                 // Call callback to handle error if any
-                if (onError)
-                    onError(errorMsg);
+                if (d.onError)
+                    d.onError(errorMsg);
             }
             catch (...)
             {
@@ -175,8 +244,8 @@ struct Job
                 errorMsg = "Unknown exception";
 
                 // Call callback to handle error if any
-                if (onError)
-                    onError(errorMsg);
+                if (d.onError)
+                    d.onError(errorMsg);
             }
 
             auto duration = chrono::steady_clock::now() - start;
@@ -191,16 +260,16 @@ struct Job
             }
 
             // Call callback to report test result if any
-            if (onAttempt)
-                onAttempt(attempt, success, elapsed, errorMsg);
+            if (d.onAttempt)
+                d.onAttempt(attempt, success, elapsed, errorMsg);
 
             if (success && (timeoutMs == 0 || elapsed <= timeoutMs))
             {
                 // Update status successfully
                 status = JobStatus::Success;
 
-                if (onComplete)
-                    onComplete(true, attempt, elapsed); // Call callback on successful completion
+                if (d.onComplete)
+                    d.onComplete(true, attempt, elapsed); // Call callback on successful completion
 
                 return true;
             }
@@ -211,11 +280,11 @@ struct Job
                 // Update timeout status
                 status = JobStatus::Timeout;
 
-                if (onTimeout)
-                    onTimeout(); // Call the timeout handling callback
+                if (d.onTimeout)
+                    d.onTimeout(); // Call the timeout handling callback
 
-                if (onComplete)
-                    onComplete(false, attempt, elapsed); // Calling the completion callback failed due to timeout
+                if (d.onComplete)
+                    d.onComplete(false, attempt, elapsed); // Calling the completion callback failed due to timeout
 
                 return false;
             }
@@ -223,9 +292,11 @@ struct Job
 
         // If all retryCount attempts fail
         status = JobStatus::Failed; // Update failed status
-        if (onComplete)
-            onComplete(false, retryCount + 1, 0); // Call callback on failed completion
+        if (d.onComplete)
+            d.onComplete(false, retryCount + 1, 0); // Call callback on failed completion
 
         return false;
     }
-};
\ No newline at end of file
+};
+
+static_assert(sizeof(Job) <= 128, "Job should stay within two cache lines");
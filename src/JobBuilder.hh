@@ -2,19 +2,53 @@
 
 #include "Job.hh"
 #include "JobResult.hh"
+#include "TypedJob.hh"
+
+#include <stdexcept>
+#include <type_traits>
 
 /*
 configure and create Job objects dynamically in the "builder pattern" style
+- the builder is a template: every build() stamps a job that shares the
+  builder's JobDetails block (strings and callbacks) and copies its priority,
+  retries and timeout; only the task is moved out, so later builds need one
+  of their own (withTask, or build(task))
+- stamped jobs are numbered from withNumber() (0 by default) upwards
+- id / category / callbacks cannot change once a job shares them: reset() first
+- callbacks are called on one shared instance, possibly from several workers
+  at once: they must be callable as const (no mutable lambda)
 */
 
 class JobBuilder
 {
 private:
+    // Hot settings and the pending task
     Job job;
+    // Shared by every job built so far
+    shared_ptr<JobDetails> details;
+
+    JobDetails &editDetails()
+    {
+        if (!details)
+            details = make_shared<JobDetails>();
+        else if (details.use_count() > 1)
+            throw logic_error("JobBuilder: details are shared by jobs already built, reset() first");
+
+        return *details;
+    }
+
+    // Every job built calls the same instance: reject callbacks with state of their own
+    template <typename... Args, typename F>
+    static F shared(F callback)
+    {
+        static_assert(is_invocable_v<const F &, Args...>,
+                      "JobBuilder: callbacks are shared by every job built and must be callable as const");
+        return callback;
+    }
 
 public:
     // main job function
-    JobBuilder &withTask(function<void()> t)
+    JobBuilder &withTask(decltype(Job::tasks) t)
     {
         job.tasks = std::move(t);
         return *this;
@@ -40,70 +74,103 @@ public:
         return *this;
     }
 
+    // Set the numeric id of the next job built
+    JobBuilder &withNumber(uint64_t n)
+    {
+        job.number = n;
+        return *this;
+    }
+
     // Set the ID for the Job
     JobBuilder &withId(const string &id)
     {
-        job.id = id;
+        editDetails().id = id;
         return *this;
     }
 
     JobBuilder &withCategory(const string &cat)
     {
-        job.category = cat;
+        editDetails().category = cat;
         return *this;
     }
 
     // Set callback when job completes (success or failure)
-    JobBuilder &onResult(function<void(const JobResult &)> callback)
+    template <typename F>
+    JobBuilder &onResult(F callback)
     {
-        job.onResult = std::move(callback);
+        editDetails().onResult = shared<const JobResult &>(std::move(callback));
         return *this;
     }
 
     // Set callback when job starts running
-    JobBuilder &onStart(function<void()> callback)
+    template <typename F>
+    JobBuilder &onStart(F callback)
     {
-        job.onStart = std::move(callback);
+        editDetails().onStart = shared<>(std::move(callback));
         return *this;
     }
 
     // Set up a callback when the job encounters an error
-    JobBuilder &onError(function<void(const string &)> callback)
+    template <typename F>
+    JobBuilder &onError(F callback)
     {
-        job.onError = std::move(callback);
+        editDetails().onError = shared<const string &>(std::move(callback));
         return *this;
     }
 
     // Set callback when job times out
-    JobBuilder &onTimeout(function<void()> callback)
+    template <typename F>
+    JobBuilder &onTimeout(F callback)
     {
-        job.onTimeout = std::move(callback);
+        editDetails().onTimeout = shared<>(std::move(callback));
         return *this;
     }
 
     // Returns the configured Job object
     Job build()
     {
-        return std::move(job);
+        Job built(std::move(job.tasks));
+        built.number = job.number++;
+        built.cold = details;
+        built.priority = job.priority;
+        built.retryCount = job.retryCount;
+        built.timeoutMs = job.timeoutMs;
+        return built;
+    }
+
+    // Stamp a job with its own task from this template
+    Job build(decltype(Job::tasks) t)
+    {
+        job.tasks = std::move(t);
+        return build();
     }
 
     // Set callback when job completes
-    JobBuilder &onComplete(function<void(bool, int, long long)> callback)
+    template <typename F>
+    JobBuilder &onComplete(F callback)
     {
-        job.onComplete = std::move(callback);
+        editDetails().onComplete = shared<bool, int, long long>(std::move(callback));
         return *this;
     }
 
     // Set callback each time
-    JobBuilder &onAttempt(function<void(int, bool, long long, string_view)> callback)
+    template <typename F>
+    JobBuilder &onAttempt(F callback)
     {
-        job.onAttempt = std::move(callback);
+        editDetails().onAttempt = shared<int, bool, long long, string_view>(std::move(callback));
         return *this;
     }
 
+    // Builder for a TypedJob: task and callbacks stored by value, erased only at dispatch
+    static TypedJobBuilder<> typed()
+    {
+        return {};
+    }
+
     JobBuilder &reset()
     {
         job = Job{};
+        details.reset();
         return *this;
     }
 };
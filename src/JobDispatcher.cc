@@ -1,14 +1,20 @@
 #include "JobDispatcher.hh"
 
-JobDispatcher::JobDispatcher(int n) : numThreads(n)
+#include <bit>
+
+JobDispatcher::JobDispatcher(int n, size_t requestedStrands)
+    : numThreads(n), strandBits(strandBitsFor(n, requestedStrands)), strands(make_unique<KeyedStrand[]>(strandCount()))
 {
     // Create job queues
     for (int i = 0; i < numThreads; ++i)
+    {
         queues.emplace_back(make_unique<LockFreeDeque<Job>>());
+        allQueues.push_back(queues.back().get());
+    }
 
     // Create Workers
     for (int i = 0; i < numThreads; ++i)
-        workers.emplace_back(make_unique<Worker>(*queues[i], getAllQueues()));
+        workers.emplace_back(make_unique<Worker>(*queues[i], allQueues, &feed));
 }
 
 // dispatch (distribute) a job to a specific worker's queue, based on the threadIndex
@@ -24,6 +30,41 @@ void JobDispatcher::dispatch(int threadIndex, unique_ptr<Job> job)
     queues[threadIndex]->pushBottom(std::move(job));
 }
 
+void JobDispatcher::dispatch(unique_ptr<Job> job)
+{
+    size_t index = nextQueue.fetch_add(1, memory_order_relaxed) % queues.size();
+    queues[index]->pushBottom(std::move(job));
+}
+
+void JobDispatcher::dispatchToStrand(size_t keyHash, unique_ptr<Job> job)
+{
+    // Fibonacci hashing: std::hash of an integer is often the integer itself
+    size_t index = strandBits ? (static_cast<uint64_t>(keyHash) * 0x9E3779B97F4A7C15ull) >> (64 - strandBits) : 0;
+    KeyedStrand &strand = strands[index];
+
+    if (strand.push(std::move(job)))
+        scheduleStrand(strand);
+}
+
+// `requested` rounded up to a power of two, or sized from the worker count when 0
+int JobDispatcher::strandBitsFor(int workers, size_t requested)
+{
+    size_t count = requested ? requested : max(minStrands, static_cast<size_t>(max(workers, 1)) * strandsPerWorker);
+    return countr_zero(bit_ceil(count));
+}
+
+// Queue a job that drains the strand; it goes back to a queue while jobs remain
+void JobDispatcher::scheduleStrand(KeyedStrand &strand)
+{
+    auto drainer = make_unique<Job>([this, &strand]()
+                                    {
+        if (strand.drain(strandBudget))
+            scheduleStrand(strand); });
+    drainer->spawned = true;
+
+    dispatch(std::move(drainer));
+}
+
 void JobDispatcher::stop()
 {
     // Send stop signal to each worker
@@ -34,16 +75,3 @@ void JobDispatcher::stop()
     for (auto &w : workers)
         w->join();
 }
-
-vector<LockFreeDeque<Job> *> &JobDispatcher::getAllQueues()
-{
-    static vector<LockFreeDeque<Job> *> all;
-
-    if (all.empty())
-    {
-        for (auto &q : queues)
-            all.push_back(q.get()); // get raw pointer (LockFreeDeque<Job>*) from unique_ptr
-    }
-
-    return all;
-}
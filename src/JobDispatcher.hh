@@ -3,21 +3,111 @@
 #include "LockFreeDeque.hh"
 #include "Worker.hh"
 #include "Job.hh"
+#include "JobFeed.hh"
+#include "JobHandle.hh"
+#include "KeyedStrand.hh"
+#include "TypedJob.hh"
 
 class JobDispatcher
 {
 public:
-    explicit JobDispatcher(int n);
+    /*
+    `n` workers, each with its own queue. `requestedStrands` sizes the table
+    behind dispatchKeyed (rounded up to a power of two); 0 sizes it from the
+    worker count, strandsPerWorker each and at least minStrands.
+    */
+    explicit JobDispatcher(int n, size_t requestedStrands = 0);
     void dispatch(int threadIndex, unique_ptr<Job> job);
+
+    // Dispatch to the workers' queues in turn
+    void dispatch(unique_ptr<Job> job);
+
+    // Erases the typed job into a single pooled Job node
+    template <typename F, typename... Policies>
+    void dispatch(int threadIndex, TypedJob<F, Policies...> job)
+    {
+        dispatch(threadIndex, std::move(job).toJob());
+    }
+
+    // Dispatches the typed job; its result (and returned value) arrive through the handle
+    template <typename F, typename... Policies>
+    JobHandle<typename TypedJob<F, Policies...>::Value> submit(int threadIndex, TypedJob<F, Policies...> job)
+    {
+        using Value = typename TypedJob<F, Policies...>::Value;
+        static_assert(!TypedJob<F, Policies...>::hasValue, "submit: the job delivers its value to onValue already");
+
+        JobPromise<Value> promise;
+        JobHandle<Value> handle = promise.handle();
+        dispatch(threadIndex, std::move(job).with(OnValue<JobPromise<Value>>{std::move(promise)}));
+        return handle;
+    }
+
+    /*
+    Jobs with equal keys run one at a time, in dispatch order; different keys
+    run in parallel on any worker.
+    - keys are hashed onto a fixed table of strands (see strandCount()): two
+      distinct keys landing on the same strand are serialised together, in
+      dispatch order, as if they were one key. Both still make progress, but
+      a long job of one delays the other
+    - with many keys busy at once, a larger requestedStrands (constructor)
+      makes such collisions rarer
+    */
+    template <typename K>
+    void dispatchKeyed(const K &key, unique_ptr<Job> job)
+    {
+        dispatchToStrand(hash<K>{}(key), std::move(job));
+    }
+
+    template <typename K, typename F, typename... Policies>
+    void dispatchKeyed(const K &key, TypedJob<F, Policies...> job)
+    {
+        dispatchKeyed(key, std::move(job).toJob());
+    }
+
+    /*
+    Jobs pulled from `source` by the workers, one batch at a time as their
+    queues run dry: a range, or a callable returning the next job (see JobFeed).
+    Returns at once; only the batches in flight are materialised.
+    */
+    template <typename S>
+    void submitFrom(S &&source)
+    {
+        feed.add(JobFeed::makeSource(std::forward<S>(source)));
+    }
+
+    // Strands keys are hashed onto by dispatchKeyed
+    size_t strandCount() const { return size_t(1) << strandBits; }
+
+    // The sources behind submitFrom: whether any is left, jobs pulled, sources dropped and why
+    const JobFeed &jobFeed() const { return feed; }
+
     void stop();
 
 private:
     // Job queue list, each thread (worker) has its own queue
     vector<unique_ptr<LockFreeDeque<Job>>> queues;
+    // Raw view of `queues` shared by the workers for stealing
+    vector<LockFreeDeque<Job> *> allQueues;
+    // Lazy sources the workers pull from; outlives them
+    JobFeed feed;
     // List of workers (threads that process work)
     vector<unique_ptr<Worker>> workers;
     // Number of workers (and corresponding queues)
     int numThreads;
+    // Round-robin position of dispatch(job), shared with ready strands
+    atomic<size_t> nextQueue{0};
+
+    // Strand table sizing when the constructor is not given a count
+    static constexpr size_t strandsPerWorker = 64;
+    static constexpr size_t minStrands = 1024;
+    // Jobs a strand runs before it makes way for other work
+    static constexpr size_t strandBudget = 16;
+    // log2 of the strand table size
+    int strandBits;
+    unique_ptr<KeyedStrand[]> strands;
+
+    static int strandBitsFor(int workers, size_t requested);
 
-    vector<LockFreeDeque<Job> *> &getAllQueues();
+    void dispatchToStrand(size_t keyHash, unique_ptr<Job> job);
+    void scheduleStrand(KeyedStrand &strand);
 };
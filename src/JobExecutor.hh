@@ -3,17 +3,21 @@
 #include "Job.hh"
 #include "Logger.hh"
 
+#include <atomic>
 #include <thread>
 #include <future>
 
 class JobExecutor
 {
 public:
-    static JobResult execute(const Job &job)
+    // Not const: a timed job with a move-only task has it moved behind a shared_ptr (see shareTask)
+    static JobResult execute(Job &job)
     {
+        const JobDetails &details = job.details();
+
         JobResult result;
-        result.jobId = job.id;
-        result.category = job.category;
+        result.jobId = details.id;
+        result.category = details.category;
         result.startTime = system_clock::now();
 
         bool success = false;
@@ -22,8 +26,11 @@ public:
         long long durationMs = 0;
         long long lastAttemptDuration = 0;
 
-        if (job.onStart)
-            job.onStart();
+        if (details.onStart)
+            details.onStart();
+
+        // A copyable task gives each timed attempt its own copy instead
+        SharedTask sharedTask = job.timeoutMs > 0 && !job.tasks.copyable() ? shareTask(job) : nullptr;
 
         auto overallStart = steady_clock::now(); // measure total job time
 
@@ -31,7 +38,7 @@ public:
         {
             auto attemptStart = steady_clock::now();
 
-            success = tryRun(job, errorMessage, job.timeoutMs);
+            success = tryRun(job, sharedTask, errorMessage, job.timeoutMs);
 
             auto attemptEnd = steady_clock::now();
             lastAttemptDuration = duration_cast<milliseconds>(attemptEnd - attemptStart).count();
@@ -39,8 +46,15 @@ public:
             if (success)
                 break;
 
-            if (!success && !errorMessage.empty() && job.onError)
-                job.onError(errorMessage);
+            if (!success && !errorMessage.empty() && details.onError)
+                details.onError(errorMessage);
+
+            // An abandoned attempt still runs the task: a retry would run it concurrently
+            if (sharedTask && sharedTask->running.load(memory_order_acquire))
+            {
+                ++attempts;
+                break;
+            }
         }
 
         auto overallEnd = steady_clock::now();
@@ -54,31 +68,77 @@ public:
         if (!success && !errorMessage.empty())
             result.errorMessage = errorMessage;
 
-        if (!success && job.onTimeout && totalDurationMs >= job.timeoutMs)
-            job.onTimeout();
+        if (!success && details.onTimeout && totalDurationMs >= job.timeoutMs)
+            details.onTimeout();
 
         // If all fails & timeout callback is set
-        if (!success && durationMs >= job.timeoutMs && job.onTimeout)
-            job.onTimeout();
+        if (!success && durationMs >= job.timeoutMs && details.onTimeout)
+            details.onTimeout();
 
         // Log & Callback
-        Logger::dualSafeLog("[JobExecutor] Job " + job.id + " done in " + to_string(durationMs) + "ms. " + (success ? "Success" : "Failed"));
+        Logger::dualSafeLog("[JobExecutor] Job " + details.id + " done in " + to_string(durationMs) + "ms. " + (success ? "Success" : "Failed"));
 
-        if (job.onResult)
-            job.onResult(result);
+        if (details.onResult)
+            details.onResult(result);
 
         return result;
     }
 
 private:
-    static bool tryRun(const Job &job, string &error, int timeoutMs)
+    struct TimedTask
+    {
+        decltype(Job::tasks) task;
+        atomic<bool> running{false}; // An attempt thread is inside task
+    };
+
+    using SharedTask = shared_ptr<TimedTask>;
+
+    /*
+    A timed attempt runs on its own thread, which is abandoned when it overruns
+    and may outlive the job. A copyable task is copied into each attempt, as
+    with std::function; a move-only one cannot be, so it is moved behind a
+    shared_ptr that the job and every attempt thread share.
+    - every attempt runs the same instance: state a stateful task changes in
+      one attempt is seen by the next
+    - no retry is made while an abandoned attempt is still running it, so a
+      move-only task that timed out is not retried
+    */
+    static SharedTask shareTask(Job &job)
+    {
+        auto shared = make_shared<TimedTask>();
+        shared->task = std::move(job.tasks);
+        job.tasks = [shared]()
+        { shared->task(); };
+        return shared;
+    }
+
+    static bool tryRun(const Job &job, const SharedTask &sharedTask, string &error, int timeoutMs)
     {
         try
         {
             if (timeoutMs > 0)
             {
                 // Run with timeout
-                packaged_task<void()> task(job.tasks);
+                packaged_task<void()> task;
+                if (!sharedTask)
+                    task = packaged_task<void()>(job.tasks.copy()); // Owned by the attempt thread
+                else
+                {
+                    sharedTask->running.store(true, memory_order_relaxed);
+                    task = packaged_task<void()>([sharedTask]()
+                                                 {
+                        try
+                        {
+                            sharedTask->task();
+                        }
+                        catch (...)
+                        {
+                            sharedTask->running.store(false, memory_order_release);
+                            throw;
+                        }
+                        sharedTask->running.store(false, memory_order_release); });
+                }
+
                 auto fut = task.get_future();
                 thread t(std::move(task));
 
@@ -90,6 +150,7 @@ private:
                 }
 
                 t.join();
+                fut.get(); // Rethrows what the attempt threw
             }
             else
             {
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "InplaceFunction.hh"
+#include "Job.hh"
+#include "Logger.hh"
+#include "TypedJob.hh"
+
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <vector>
+
+/*
+Lazy job sources shared by a JobDispatcher's workers (see submitFrom)
+- a worker whose deque runs dry pulls the next batch (up to batchSize jobs),
+  so at most one batch per worker is materialised ahead of execution
+- sources are drained in the order they were added, one thread at a time:
+  a source does not need to be thread-safe
+- a source is:
+    a range (e.g. a lazy view) of jobs; its elements are moved out, and a
+    range passed as an lvalue must outlive the pulling
+    a callable returning the next job: unique_ptr<Job> (nullptr when done)
+    or optional<X> (nullopt when done)
+  where a job is a unique_ptr<Job>, a Job or a TypedJob
+- a source that throws is dropped: the failure is logged, counted in
+  droppedSources() and the first exception kept for error(); jobs it produced
+  before throwing still run
+*/
+class JobFeed
+{
+public:
+    static constexpr size_t batchSize = 32;
+
+    // Appends up to `max` jobs to `out`; fewer means the source is exhausted
+    using Source = UniqueFunction<size_t(vector<unique_ptr<Job>> &out, size_t max)>;
+
+    template <typename S>
+    static Source makeSource(S &&source)
+    {
+        if constexpr (is_same_v<remove_cvref_t<S>, Source>)
+            return std::forward<S>(source); // Already one, e.g. wrapped by JobGroup::addFrom
+        else if constexpr (ranges::input_range<remove_reference_t<S>>)
+            return fromRange(std::forward<S>(source));
+        else
+            return fromCallable(std::forward<S>(source));
+    }
+
+    void add(Source source)
+    {
+        lock_guard<mutex> lock(mtx);
+        sources.push_back(std::move(source));
+        active.store(true, memory_order_release);
+    }
+
+    // Lock-free check for workers: false once every source is exhausted
+    bool hasWork() const
+    {
+        return active.load(memory_order_acquire);
+    }
+
+    // Appends the next batch to `out`; returns how many jobs were pulled
+    size_t pull(vector<unique_ptr<Job>> &out)
+    {
+        lock_guard<mutex> lock(mtx);
+        size_t before = out.size();
+        size_t pulled = 0;
+
+        while (pulled < batchSize && !sources.empty())
+        {
+            size_t wanted = batchSize - pulled;
+            size_t got = 0;
+            exception_ptr failure;
+
+            try
+            {
+                got = sources.front()(out, wanted);
+            }
+            catch (...)
+            {
+                failure = current_exception();
+            }
+
+            pulled = out.size() - before;
+            if (failure)
+                drop(failure);
+            else if (got < wanted)
+                sources.pop_front();
+        }
+
+        // Counted before hasWork() turns false, so a reader seeing it false sees every job
+        pulledCount.fetch_add(pulled, memory_order_relaxed);
+        if (sources.empty())
+            active.store(false, memory_order_release);
+
+        return pulled;
+    }
+
+    // Jobs pulled from every source so far
+    size_t pulledJobs() const
+    {
+        return pulledCount.load(memory_order_relaxed);
+    }
+
+    // Sources dropped because they threw
+    size_t droppedSources() const
+    {
+        return dropped.load(memory_order_acquire);
+    }
+
+    // The first exception a dropped source threw, nullptr when none did
+    exception_ptr error() const
+    {
+        lock_guard<mutex> lock(mtx);
+        return firstError;
+    }
+
+private:
+    mutable mutex mtx;
+    deque<Source> sources;
+    atomic<bool> active{false};
+    atomic<size_t> pulledCount{0};
+    atomic<size_t> dropped{0};
+    exception_ptr firstError;
+
+    // Called with mtx held
+    void drop(exception_ptr failure)
+    {
+        string what = "Unknown exception";
+        try
+        {
+            rethrow_exception(failure);
+        }
+        catch (const exception &e)
+        {
+            what = e.what();
+        }
+        catch (...)
+        {
+        }
+
+        Logger::dualSafeLog("[JobFeed] Source dropped after throwing: " + what);
+
+        sources.pop_front();
+        if (!firstError)
+            firstError = failure;
+        dropped.fetch_add(1, memory_order_release);
+    }
+
+    static unique_ptr<Job> toNode(unique_ptr<Job> job) { return job; }
+    static unique_ptr<Job> toNode(Job &&job) { return make_unique<Job>(std::move(job)); }
+
+    template <typename F, typename... Policies>
+    static unique_ptr<Job> toNode(TypedJob<F, Policies...> &&job)
+    {
+        return std::move(job).toJob();
+    }
+
+    template <typename R>
+    static Source fromRange(R &&range)
+    {
+        using View = views::all_t<R>;
+
+        // On the heap: the iterator may point into the view
+        struct State
+        {
+            View view;
+            ranges::iterator_t<View> it;
+
+            explicit State(View v) : view(std::move(v)), it(ranges::begin(view)) {}
+        };
+
+        auto state = make_unique<State>(views::all(std::forward<R>(range)));
+        return [state = std::move(state)](vector<unique_ptr<Job>> &out, size_t max)
+        {
+            size_t n = 0;
+            for (; n < max && state->it != ranges::end(state->view); ++n, ++state->it)
+                out.push_back(toNode(std::move(*state->it)));
+            return n;
+        };
+    }
+
+    template <typename F>
+    static Source fromCallable(F &&next)
+    {
+        return [next = std::forward<F>(next)](vector<unique_ptr<Job>> &out, size_t max) mutable
+        {
+            size_t n = 0;
+            for (; n < max; ++n)
+            {
+                auto job = next();
+                if (!job)
+                    break;
+
+                if constexpr (is_same_v<decltype(job), unique_ptr<Job>>)
+                    out.push_back(std::move(job));
+                else
+                    out.push_back(toNode(std::move(*job)));
+            }
+            return n;
+        };
+    }
+};
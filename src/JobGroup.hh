@@ -0,0 +1,438 @@
+#pragma once
+
+#include "JobDispatcher.hh"
+#include "JobExecutor.hh"
+#include "TypedJob.hh"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// Outcome of a JobGroup's jobs so far
+struct JobGroupSummary
+{
+    // Bucket i counts run times below 2^i microseconds; the last bucket takes the rest
+    static constexpr size_t latencyBuckets = 24;
+
+    size_t succeeded = 0;
+    size_t failed = 0;
+    size_t cancelled = 0; // Skipped after cancel(), or dropped unrun by the dispatcher
+    array<size_t, latencyBuckets> latencyHistogram{};
+
+    size_t completed() const { return succeeded + failed + cancelled; }
+
+    // Exclusive upper bound of bucket i, in microseconds (the last one has none)
+    static long long bucketLimitUs(size_t i) { return 1LL << i; }
+};
+
+/*
+A batch of jobs submitted, awaited and cancelled as a unit
+- add() dispatches each job round-robin onto the dispatcher's workers:
+  a unique_ptr<Job> (run as a worker would), a TypedJob or a plain callable
+  (failed when it throws, or returns false)
+- addFrom() takes a lazy source instead, as JobDispatcher::submitFrom: its
+  jobs join the group as the workers pull them
+- wait() blocks, `co_await group` suspends (and resumes on the worker that
+  finishes the last job) until every job added so far has completed, and
+  every source has run dry; both give the summary
+- cancel() skips the jobs that have not started yet; running jobs finish
+- completions write the completing thread's slot (its own cache lines), and
+  are taken off the shared pending count in batches: a worker defers them while
+  it runs the group's jobs back to back, up to flushBatch, and settles them
+  before it runs other work or goes idle (see Worker::defer); other threads
+  settle each one at once
+- like TaskGroup, the group is driven by one thread (add, wait, cancel), its
+  jobs may run anywhere, and the destructor waits for them
+*/
+class JobGroup
+{
+public:
+    explicit JobGroup(JobDispatcher &dispatcher) : dispatcher(dispatcher) {}
+
+    ~JobGroup()
+    {
+        wait();
+    }
+
+    JobGroup(const JobGroup &) = delete;
+    JobGroup &operator=(const JobGroup &) = delete;
+
+    void add(unique_ptr<Job> job)
+    {
+        submit(RunAsWorker{std::move(job)});
+    }
+
+    template <typename F, typename... Policies>
+    void add(TypedJob<F, Policies...> job)
+    {
+        submit([job = std::move(job)]() mutable
+               { return job.run(); });
+    }
+
+    template <typename F>
+        requires invocable<F &>
+    void add(F task)
+    {
+        submit([task = std::move(task)]() mutable
+               {
+            if constexpr (is_same_v<invoke_result_t<F &>, bool>)
+                return task();
+            else
+            {
+                task();
+                return true;
+            } });
+    }
+
+    /*
+    Jobs pulled lazily from `source`: a range, or a callable returning the next
+    job (see JobFeed). Returns at once. A source that throws is dropped by the
+    dispatcher's feed; the jobs it produced until then still belong to the group.
+    */
+    template <typename S>
+    void addFrom(S &&source)
+    {
+        pending.fetch_add(1, memory_order_seq_cst); // The source itself, until it runs dry
+        dispatcher.submitFrom(JobFeed::Source(GroupSource(this, JobFeed::makeSource(std::forward<S>(source)))));
+    }
+
+    JobGroupSummary wait()
+    {
+        // This thread may hold completions of its own
+        flushDeferred();
+        watched.store(true, memory_order_seq_cst);
+
+        while (true)
+        {
+            uint32_t seen = generation.load(memory_order_acquire);
+            if (finished())
+                break;
+            generation.wait(seen, memory_order_acquire);
+        }
+
+        // The last completer may still be notifying; it leaves the group alone after that
+        while (closing.load(memory_order_acquire) != 0)
+            this_thread::yield();
+
+        return summary();
+    }
+
+    auto operator co_await()
+    {
+        flushDeferred();
+
+        struct Awaiter
+        {
+            JobGroup &group;
+
+            bool await_ready() const { return group.finished() && group.closing.load(memory_order_acquire) == 0; }
+
+            bool await_suspend(coroutine_handle<> h)
+            {
+                group.continuation.store(h.address(), memory_order_seq_cst);
+                group.watched.store(true, memory_order_seq_cst);
+
+                // Finished in between: take the continuation back, unless a completer has it
+                if (group.finished())
+                    return group.continuation.exchange(nullptr, memory_order_acq_rel) == nullptr;
+                return true;
+            }
+
+            JobGroupSummary await_resume()
+            {
+                while (group.closing.load(memory_order_acquire) != 0)
+                    this_thread::yield();
+                return group.summary();
+            }
+        };
+
+        return Awaiter{*this};
+    }
+
+    void cancel()
+    {
+        cancelRequested.store(true, memory_order_relaxed);
+    }
+
+    bool cancelled() const
+    {
+        return cancelRequested.load(memory_order_relaxed);
+    }
+
+    // Jobs added so far, including those pulled from sources
+    size_t size() const
+    {
+        return submitted.load(memory_order_relaxed);
+    }
+
+    // Counts of the jobs completed so far
+    JobGroupSummary summary() const
+    {
+        JobGroupSummary total;
+        for (const Slot &slot : slots)
+        {
+            total.succeeded += slot.succeeded.load(memory_order_acquire);
+            total.failed += slot.failed.load(memory_order_acquire);
+            total.cancelled += slot.cancelled.load(memory_order_acquire);
+            for (size_t i = 0; i < JobGroupSummary::latencyBuckets; ++i)
+                total.latencyHistogram[i] += slot.latency[i].load(memory_order_relaxed);
+        }
+
+        return total;
+    }
+
+private:
+    static constexpr size_t slotCount = 32;
+    // Completions a worker defers before it settles them anyway
+    static constexpr size_t flushBatch = 64;
+
+    enum class Outcome
+    {
+        Succeeded,
+        Failed,
+        Cancelled
+    };
+
+    struct alignas(64) Slot
+    {
+        atomic<size_t> succeeded{0};
+        atomic<size_t> failed{0};
+        atomic<size_t> cancelled{0};
+        atomic<size_t> latency[JobGroupSummary::latencyBuckets]{};
+    };
+
+    // Runs the job unless the group was cancelled; reports a cancellation when dropped unrun
+    template <typename Body>
+    class Entry
+    {
+    public:
+        Entry(JobGroup *group, Body body) : group(group), body(std::move(body)) {}
+        Entry(Entry &&other) noexcept : group(std::exchange(other.group, nullptr)), body(std::move(other.body)) {}
+
+        ~Entry()
+        {
+            if (group)
+                group->complete(Outcome::Cancelled, 0);
+        }
+
+        void operator()()
+        {
+            JobGroup *g = std::exchange(group, nullptr);
+            if (g->cancelled())
+            {
+                g->complete(Outcome::Cancelled, 0);
+                return;
+            }
+
+            auto start = chrono::steady_clock::now();
+            bool success = false;
+            try
+            {
+                success = body();
+            }
+            catch (...)
+            {
+                // A thrown exception is a failure
+            }
+            long long us = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+            g->complete(success ? Outcome::Succeeded : Outcome::Failed, us);
+        }
+
+    private:
+        JobGroup *group;
+        Body body;
+    };
+
+    // A source's jobs, wrapped as they are pulled; holds the group's pending count until it runs dry
+    class GroupSource
+    {
+    public:
+        GroupSource(JobGroup *group, JobFeed::Source source) : group(group), source(std::move(source)) {}
+        GroupSource(GroupSource &&other) noexcept : group(std::exchange(other.group, nullptr)), source(std::move(other.source)) {}
+
+        // Dropped before running dry, e.g. by a stopped dispatcher
+        ~GroupSource()
+        {
+            if (group)
+                std::exchange(group, nullptr)->release(1);
+        }
+
+        size_t operator()(vector<unique_ptr<Job>> &out, size_t max)
+        {
+            if (!group)
+                return 0;
+
+            size_t before = out.size();
+            size_t got = 0;
+            try
+            {
+                got = source(out, max);
+            }
+            catch (...)
+            {
+                adopt(out, before);
+                std::exchange(group, nullptr)->release(1);
+                throw; // The feed logs and drops the source
+            }
+
+            adopt(out, before);
+            if (got < max)
+                std::exchange(group, nullptr)->release(1);
+            return got;
+        }
+
+    private:
+        JobGroup *group;
+        JobFeed::Source source;
+
+        // Counted before the source's own hold is released, so the group cannot finish in between
+        void adopt(vector<unique_ptr<Job>> &out, size_t from)
+        {
+            if (out.size() == from)
+                return;
+
+            group->pending.fetch_add(out.size() - from, memory_order_seq_cst);
+            group->submitted.fetch_add(out.size() - from, memory_order_relaxed);
+            for (size_t i = from; i < out.size(); ++i)
+                out[i] = group->node(RunAsWorker{std::move(out[i])});
+        }
+    };
+
+    // Completions this thread has not taken off a group's pending count yet
+    struct Deferred
+    {
+        JobGroup *group = nullptr;
+        size_t count = 0;
+    };
+
+    static thread_local Deferred deferred;
+
+    JobDispatcher &dispatcher;
+    Slot slots[slotCount];
+
+    // Jobs (and sources) added and not completed yet, less the completions deferred;
+    // written on add, and by completers once per batch
+    alignas(64) atomic<size_t> pending{0};
+    atomic<size_t> submitted{0};
+    // Completers notifying the waiter right now
+    atomic<size_t> closing{0};
+    // Read by completers; written once someone waits
+    alignas(64) atomic<bool> watched{false};
+    atomic<bool> cancelRequested{false};
+    atomic<uint32_t> generation{0};
+    atomic<void *> continuation{nullptr};
+
+    // Body of a job added as a Job: run the way a worker would
+    struct RunAsWorker
+    {
+        unique_ptr<Job> job;
+
+        bool operator()()
+        {
+            if (!job->spawned)
+                return JobExecutor::execute(*job).success;
+            job->tasks();
+            return true;
+        }
+    };
+
+    template <typename Body>
+    unique_ptr<Job> node(Body body)
+    {
+        auto job = make_unique<Job>(Entry<Body>(this, std::move(body)));
+        job->spawned = true;
+        job->group = this;
+        return job;
+    }
+
+    template <typename Body>
+    void submit(Body body)
+    {
+        pending.fetch_add(1, memory_order_seq_cst);
+        submitted.fetch_add(1, memory_order_relaxed);
+        dispatcher.dispatch(node(std::move(body)));
+    }
+
+    // Slot of the calling thread, fixed for its lifetime
+    static size_t threadSlot()
+    {
+        static atomic<size_t> nextSlot{0};
+        thread_local size_t slot = nextSlot.fetch_add(1, memory_order_relaxed) % slotCount;
+        return slot;
+    }
+
+    bool finished() const
+    {
+        return pending.load(memory_order_seq_cst) == 0;
+    }
+
+    void complete(Outcome outcome, long long us)
+    {
+        // Own cache lines; published to the waiter by the release below
+        Slot &slot = slots[threadSlot()];
+        if (outcome != Outcome::Cancelled)
+        {
+            size_t bucket = us <= 0 ? 0 : min<size_t>(bit_width(static_cast<unsigned long long>(us)), JobGroupSummary::latencyBuckets - 1);
+            slot.latency[bucket].fetch_add(1, memory_order_relaxed);
+        }
+
+        atomic<size_t> &counter = outcome == Outcome::Succeeded ? slot.succeeded : outcome == Outcome::Failed ? slot.failed
+                                                                                                              : slot.cancelled;
+        counter.fetch_add(1, memory_order_relaxed);
+
+        // Off the workers nothing would settle a deferral
+        if (!Worker::current())
+        {
+            release(1);
+            return;
+        }
+
+        if (deferred.group != this)
+        {
+            flushDeferred();
+            deferred.group = this;
+            Worker::defer(this, &JobGroup::flushDeferred);
+        }
+
+        if (++deferred.count >= flushBatch)
+            release(std::exchange(deferred.count, 0));
+    }
+
+    // Settles the calling thread's deferred completions
+    static void flushDeferred()
+    {
+        Deferred d = std::exchange(deferred, Deferred{});
+        if (d.count > 0)
+            d.group->release(d.count);
+    }
+
+    // Takes `n` completions off the pending count; the one reaching zero wakes the waiter
+    void release(size_t n)
+    {
+        closing.fetch_add(1, memory_order_seq_cst);
+
+        void *resume = nullptr;
+        if (pending.fetch_sub(n, memory_order_seq_cst) == n && watched.load(memory_order_seq_cst))
+        {
+            generation.fetch_add(1, memory_order_release);
+            generation.notify_all();
+            resume = continuation.exchange(nullptr, memory_order_acq_rel);
+        }
+
+        // The group may be gone once this is released
+        closing.fetch_sub(1, memory_order_release);
+
+        if (resume)
+            coroutine_handle<>::from_address(resume).resume();
+    }
+};
+
+inline thread_local JobGroup::Deferred JobGroup::deferred;
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "JobResult.hh"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace job_handle_detail
+{
+    template <typename T>
+    struct State
+    {
+        optional<JobResultOf<T>> result;
+        atomic<bool> ready{false};
+    };
+}
+
+template <typename T>
+class JobPromise;
+
+/*
+Where the result of a submitted TypedJob arrives (see JobDispatcher::submit)
+- one shared state per job: the worker moves the result in, get() moves it
+  out, so a returned value is never copied
+- a job dropped before it ran (e.g. still queued at stop()) resolves with
+  success = false
+*/
+template <typename T>
+class JobHandle
+{
+public:
+    bool ready() const
+    {
+        return state->ready.load(memory_order_acquire);
+    }
+
+    void wait() const
+    {
+        state->ready.wait(false, memory_order_acquire);
+    }
+
+    // Waits, then moves the result out: call once
+    JobResultOf<T> get()
+    {
+        wait();
+        return std::move(*state->result);
+    }
+
+private:
+    friend class JobPromise<T>;
+
+    explicit JobHandle(shared_ptr<job_handle_detail::State<T>> s) : state(std::move(s)) {}
+
+    shared_ptr<job_handle_detail::State<T>> state;
+};
+
+// The job's side of a JobHandle, used as its OnValue callback
+template <typename T>
+class JobPromise
+{
+public:
+    JobPromise() : state(make_shared<job_handle_detail::State<T>>()) {}
+
+    JobPromise(JobPromise &&) noexcept = default;
+    JobPromise &operator=(JobPromise &&) = delete;
+
+    ~JobPromise()
+    {
+        if (!state)
+            return;
+
+        JobResultOf<T> dropped;
+        dropped.errorMessage = "Job dropped before it ran";
+        (*this)(std::move(dropped));
+    }
+
+    JobHandle<T> handle() const
+    {
+        return JobHandle<T>(state);
+    }
+
+    void operator()(JobResultOf<T> &&result)
+    {
+        state->result.emplace(std::move(result));
+        state->ready.store(true, memory_order_release);
+        state->ready.notify_all();
+        state.reset();
+    }
+
+private:
+    shared_ptr<job_handle_detail::State<T>> state;
+};
@@ -0,0 +1,237 @@
+#include "JobPool.hh"
+#include "Job.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#ifdef __linux__
+#include <cstdlib>
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+    // A released job's storage, threaded into a free list
+    struct FreeBlock
+    {
+        FreeBlock *next;
+    };
+
+    constexpr size_t blockAlign = max(alignof(Job), alignof(FreeBlock));
+    constexpr size_t blockSize = (max(sizeof(Job), sizeof(FreeBlock)) + blockAlign - 1) / blockAlign * blockAlign;
+    static_assert(blockSize == sizeof(Job), "Job::operator new sizes its classes from sizeof(Job)");
+    constexpr size_t slabBytes = 64 * 1024;
+    constexpr size_t hugePageBytes = 2 * 1024 * 1024;
+
+    // Free list of `count` blocks
+    struct Batch
+    {
+        FreeBlock *head = nullptr;
+        size_t count = 0;
+
+        void push(FreeBlock *block)
+        {
+            block->next = head;
+            head = block;
+            ++count;
+        }
+
+        FreeBlock *pop()
+        {
+            FreeBlock *block = head;
+            head = block->next;
+            --count;
+            return block;
+        }
+
+        // Detach the last (least recently released) n blocks as their own batch
+        Batch splitTail(size_t n)
+        {
+            FreeBlock *last = head;
+            for (size_t i = 1; i < count - n; ++i)
+                last = last->next;
+
+            Batch tail{last->next, n};
+            last->next = nullptr;
+            count -= n;
+            return tail;
+        }
+    };
+
+    struct Shared
+    {
+        mutex mtx;
+        vector<Batch> batches[JobPool::sizeClasses];
+        atomic<bool> hugePages{false};
+        JobPool::Stats stats;
+    };
+
+    // Leaked on purpose: jobs may still be released while statics are destroyed
+    Shared &shared()
+    {
+        static Shared *instance = new Shared();
+        return *instance;
+    }
+
+    // Storage for a new slab; `bytes` is set to its size
+    void *allocateSlab(bool huge, size_t &bytes)
+    {
+#ifdef __linux__
+        if (huge)
+        {
+            bytes = hugePageBytes;
+            void *slab = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (slab != MAP_FAILED)
+                return slab;
+
+            // No hugepages reserved: ask for transparent ones on an aligned block
+            slab = aligned_alloc(hugePageBytes, bytes);
+            if (slab)
+            {
+                madvise(slab, bytes, MADV_HUGEPAGE);
+                return slab;
+            }
+        }
+#else
+        (void)huge;
+#endif
+
+        bytes = slabBytes;
+        return ::operator new(bytes);
+    }
+
+    // Smallest size class holding `size` bytes
+    size_t classOf(size_t size)
+    {
+        size_t sizeClass = 0;
+        while ((blockSize << sizeClass) < size)
+            ++sizeClass;
+        return sizeClass;
+    }
+
+    Batch carveSlab(size_t sizeClass)
+    {
+        Shared &s = shared();
+        bool huge = s.hugePages.load(memory_order_relaxed);
+        size_t bytes = 0;
+        auto *slab = static_cast<unsigned char *>(allocateSlab(huge, bytes));
+        huge = bytes == hugePageBytes;
+
+        Batch batch;
+        size_t size = blockSize << sizeClass;
+        size_t blocks = bytes / size;
+        for (size_t i = blocks; i-- > 0;)
+            batch.push(reinterpret_cast<FreeBlock *>(slab + i * size));
+
+        lock_guard<mutex> lock(s.mtx);
+        s.stats.slabs++;
+        s.stats.hugePageSlabs += huge ? 1 : 0;
+        s.stats.blocks += blocks;
+        return batch;
+    }
+
+    void giveBatch(size_t sizeClass, Batch batch)
+    {
+        Shared &s = shared();
+        lock_guard<mutex> lock(s.mtx);
+        s.batches[sizeClass].push_back(batch);
+        s.stats.sharedBlocks += batch.count;
+    }
+
+    // A batch from the shared list, or a new slab when it is empty
+    Batch takeBatch(size_t sizeClass)
+    {
+        Shared &s = shared();
+        {
+            lock_guard<mutex> lock(s.mtx);
+            vector<Batch> &batches = s.batches[sizeClass];
+            if (!batches.empty())
+            {
+                Batch batch = batches.back();
+                batches.pop_back();
+                s.stats.sharedBlocks -= batch.count;
+                return batch;
+            }
+        }
+
+        return carveSlab(sizeClass);
+    }
+
+    struct ThreadCache
+    {
+        Batch local[JobPool::sizeClasses];
+
+        ~ThreadCache();
+    };
+
+    thread_local ThreadCache cache;
+    // Trivially destructible, so still readable once `cache` is gone at thread exit
+    thread_local bool cacheAlive = true;
+
+    ThreadCache::~ThreadCache()
+    {
+        cacheAlive = false;
+        for (size_t sizeClass = 0; sizeClass < JobPool::sizeClasses; ++sizeClass)
+            if (local[sizeClass].count > 0)
+                giveBatch(sizeClass, local[sizeClass]);
+    }
+}
+
+void *JobPool::allocate(size_t size)
+{
+    size_t sizeClass = classOf(size);
+
+    if (!cacheAlive)
+    {
+        // Thread is exiting: serve from a batch and hand the rest back
+        Batch batch = takeBatch(sizeClass);
+        FreeBlock *block = batch.pop();
+        if (batch.count > 0)
+            giveBatch(sizeClass, batch);
+        return block;
+    }
+
+    Batch &local = cache.local[sizeClass];
+    if (local.count == 0)
+        local = takeBatch(sizeClass);
+
+    return local.pop();
+}
+
+void JobPool::deallocate(void *block, size_t size) noexcept
+{
+    auto *freed = static_cast<FreeBlock *>(block);
+    size_t sizeClass = classOf(size);
+
+    if (!cacheAlive)
+    {
+        Batch single;
+        single.push(freed);
+        giveBatch(sizeClass, single);
+        return;
+    }
+
+    Batch &local = cache.local[sizeClass];
+    local.push(freed);
+
+    // Mostly jobs allocated elsewhere: send a batch back where it can be reused
+    if (local.count >= 2 * batchSize)
+        giveBatch(sizeClass, local.splitTail(batchSize));
+}
+
+void JobPool::useHugePages(bool enable)
+{
+    shared().hugePages = enable;
+}
+
+JobPool::Stats JobPool::stats()
+{
+    Shared &s = shared();
+    lock_guard<mutex> lock(s.mtx);
+    Stats copy = s.stats;
+    copy.blockSize = blockSize;
+    return copy;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+
+using namespace std;
+
+/*
+Slab allocator behind Job's operator new / delete, so `make_unique<Job>` and
+the unique_ptr<Job> handed to JobDispatcher::dispatch reuse released jobs
+- jobs are carved from slabs that are never returned to the system
+- each thread keeps its own free list: a job released on the thread that
+  allocates the next one is reused straight away, without locking
+- jobs released on other threads (workers finishing what the dispatching
+  thread submitted) pile up on the releasing thread; past 2 * batchSize it
+  hands batchSize of them to a shared list in one step, and a thread whose list
+  runs dry takes a whole batch back: one lock per batchSize jobs, and no
+  malloc / free once the slabs cover the jobs in flight
+- with useHugePages(true) new slabs are 2 MiB hugepage-backed mappings
+  (MAP_HUGETLB, or transparent huge pages when none are reserved; Linux only)
+- blocks twice and four times the size of a Job serve nodes derived from it
+  (e.g. a TypedJob stored by value); each size class has its own slabs and
+  free lists
+*/
+class JobPool
+{
+public:
+    static constexpr size_t batchSize = 64;
+    static constexpr size_t sizeClasses = 3;
+
+    // Largest block served, given the size of a Job; bigger requests go to the global heap
+    static constexpr size_t maxBlockSize(size_t jobSize) { return jobSize << (sizeClasses - 1); }
+
+    struct Stats
+    {
+        size_t slabs = 0;         // Slabs carved so far
+        size_t hugePageSlabs = 0; // ... of which hugepage-backed
+        size_t blocks = 0;        // Jobs the slabs can hold
+        size_t blockSize = 0;     // Bytes per job (the smallest size class)
+        size_t sharedBlocks = 0;  // Free jobs waiting on the shared list
+    };
+
+    // Storage for a Job or a node derived from it, of at most maxBlockSize(sizeof(Job)) bytes
+    static void *allocate(size_t size);
+    static void deallocate(void *block, size_t size) noexcept;
+
+    // Back the slabs carved from now on with huge pages
+    static void useHugePages(bool enable);
+
+    static Stats stats();
+};
@@ -2,7 +2,14 @@
 
 #include <string>
 #include <chrono>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
 #include <optional>
+#include <span>
+#include <string_view>
+
+#include "NameRegistry.hh"
 
 using namespace std;
 using namespace chrono;
@@ -14,27 +21,367 @@ struct JobResult
     long long durationMs = 0;
 
     string jobId;                  // Unique ID of the job (if any)
-    string category = "default";   // Job grouping
+    CategoryName category;         // Job grouping, "default" unless set
     optional<string> errorMessage; // Only available if failed
 
     system_clock::time_point startTime;
     system_clock::time_point endTime;
 
-    string toJSON() const
+    // One JSON object; see JobResultWriter to serialise many without allocating
+    string toJSON() const;
+};
+
+// JobResult of a job whose task returns T: the value is moved in, only on success
+template <typename T>
+struct JobResultOf : JobResult
+{
+    optional<T> value;
+};
+
+template <>
+struct JobResultOf<void> : JobResult
+{
+};
+
+/*
+Appends JobResults to a caller-provided buffer, without allocating.
+- JSON: the object toJSON() returns, with every string escaped; appendJSONLines
+  writes one object per line (NDJSON) for a batch
+- binary: a compact record per result, read back with readBinary:
+    varint  length of the rest of the record
+    u8      flags (1 = success, 2 = has error)
+    varint  attempts, durationMs, startTime and endTime in microseconds since
+            the epoch (zigzag-encoded)
+    string  jobId, category, then error when flagged (varint length + bytes)
+- an append that does not fit leaves the buffer as it was and returns false:
+  hand view() on, clear(), and append again
+*/
+class JobResultWriter
+{
+public:
+    explicit JobResultWriter(span<char> buffer) : buf(buffer) {}
+
+    bool appendJSON(const JobResult &result)
+    {
+        return transaction([&]
+                           { writeJSON(result); });
+    }
+
+    // Appends results (one per line) until the buffer is full; returns how many were written
+    size_t appendJSONLines(span<const JobResult> results)
+    {
+        size_t written = 0;
+        for (const JobResult &result : results)
+        {
+            if (!transaction([&]
+                             { writeJSON(result); put('\n'); }))
+                break;
+            ++written;
+        }
+
+        return written;
+    }
+
+    bool appendBinary(const JobResult &result)
+    {
+        return transaction([&]
+                           { writeBinary(result); });
+    }
+
+    // Appends records until the buffer is full; returns how many were written
+    size_t appendBinary(span<const JobResult> results)
     {
-        string json = "{";
-        json += "\"jobId\": \"" + jobId + "\", ";
-        json += "\"category\": \"" + category + "\", ";
-        json += "\"success\": " + string(success ? "true" : "false") + ", ";
-        json += "\"attempts\": " + to_string(attempts) + ", ";
-        json += "\"durationMs\": " + to_string(durationMs) + ", ";
+        size_t written = 0;
+        for (const JobResult &result : results)
+        {
+            if (!appendBinary(result))
+                break;
+            ++written;
+        }
 
-        if (errorMessage.has_value())
-            json += "\"error\": \"" + *errorMessage + "\", ";
+        return written;
+    }
+
+    /*
+    Decode the record at the start of `in` into `out`.
+    Returns the bytes consumed, 0 when `in` does not start with a complete record.
+    The input may be untrusted, so its category is looked up, never interned: one
+    this process does not know decodes as "default", and its name is stored in
+    `unknownCategory` when given (which is cleared for a known one).
+    */
+    static size_t readBinary(span<const char> in, JobResult &out, string *unknownCategory = nullptr)
+    {
+        Reader header{in.data(), in.data() + in.size()};
+        uint64_t length = 0;
+        if (!header.varint(length) || length > static_cast<uint64_t>(header.end - header.pos))
+            return 0;
+
+        Reader r{header.pos, header.pos + length};
+        uint64_t flags = 0, attempts = 0, duration = 0, start = 0, end = 0;
+        string_view id, category, error;
+
+        if (r.pos == r.end)
+            return 0;
+        flags = static_cast<unsigned char>(*r.pos++);
+
+        if (!r.varint(attempts) || !r.varint(duration) || !r.varint(start) || !r.varint(end) ||
+            !r.text(id) || !r.text(category) || ((flags & 2) && !r.text(error)))
+            return 0;
 
-        json += "\"timestamp\": \"" + to_string(system_clock::to_time_t(endTime)) + "\"";
+        out.success = flags & 1;
+        out.attempts = static_cast<int>(unzigzag(attempts));
+        out.durationMs = unzigzag(duration);
+        out.startTime = system_clock::time_point(duration_cast<system_clock::duration>(microseconds(unzigzag(start))));
+        out.endTime = system_clock::time_point(duration_cast<system_clock::duration>(microseconds(unzigzag(end))));
+        out.jobId.assign(id);
+        optional<CategoryName> known = CategoryName::find(category);
+        out.category = known.value_or(CategoryName());
+        if (unknownCategory)
+        {
+            if (known)
+                unknownCategory->clear();
+            else
+                unknownCategory->assign(category);
+        }
+        if (flags & 2)
+            out.errorMessage = string(error);
+        else
+            out.errorMessage.reset();
 
-        json += "}";
-        return json;
+        return static_cast<size_t>(r.end - in.data());
+    }
+
+    string_view view() const { return {buf.data(), used}; }
+    size_t size() const { return used; }
+    size_t remaining() const { return buf.size() - used; }
+    void clear() { used = 0; }
+
+private:
+    span<char> buf;
+    size_t used = 0;
+    bool overflow = false;
+
+    struct Reader
+    {
+        const char *pos;
+        const char *end;
+
+        bool varint(uint64_t &value)
+        {
+            value = 0;
+            for (int shift = 0; shift < 64 && pos != end; shift += 7)
+            {
+                auto byte = static_cast<unsigned char>(*pos++);
+                value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if (!(byte & 0x80))
+                    return true;
+            }
+
+            return false;
+        }
+
+        bool text(string_view &s)
+        {
+            uint64_t length = 0;
+            if (!varint(length) || length > static_cast<uint64_t>(end - pos))
+                return false;
+
+            s = string_view(pos, length);
+            pos += length;
+            return true;
+        }
+    };
+
+    // Runs write(); on overflow rolls the buffer back to where it was
+    template <typename F>
+    bool transaction(F write)
+    {
+        size_t start = used;
+        overflow = false;
+        write();
+
+        if (overflow)
+        {
+            used = start;
+            return false;
+        }
+
+        return true;
+    }
+
+    void put(char c)
+    {
+        if (used < buf.size())
+            buf[used++] = c;
+        else
+            overflow = true;
+    }
+
+    void put(string_view s)
+    {
+        if (s.size() <= buf.size() - used)
+        {
+            memcpy(buf.data() + used, s.data(), s.size());
+            used += s.size();
+        }
+        else
+        {
+            overflow = true;
+        }
+    }
+
+    template <typename T>
+    void putNumber(T value)
+    {
+        auto [end, ec] = to_chars(buf.data() + used, buf.data() + buf.size(), value);
+        if (ec == errc())
+            used = static_cast<size_t>(end - buf.data());
+        else
+            overflow = true;
+    }
+
+    // JSON string body: quotes, backslashes and control characters escaped, runs copied whole
+    void putEscaped(string_view s)
+    {
+        static constexpr char hex[] = "0123456789abcdef";
+        size_t run = 0;
+
+        for (size_t i = 0; i < s.size(); ++i)
+        {
+            auto c = static_cast<unsigned char>(s[i]);
+            if (c >= 0x20 && c != '"' && c != '\\')
+                continue;
+
+            put(s.substr(run, i - run));
+            run = i + 1;
+
+            switch (c)
+            {
+            case '"':
+                put("\\\"");
+                break;
+            case '\\':
+                put("\\\\");
+                break;
+            case '\b':
+                put("\\b");
+                break;
+            case '\f':
+                put("\\f");
+                break;
+            case '\n':
+                put("\\n");
+                break;
+            case '\r':
+                put("\\r");
+                break;
+            case '\t':
+                put("\\t");
+                break;
+            default:
+            {
+                char unicode[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+                put(string_view(unicode, sizeof(unicode)));
+                break;
+            }
+            }
+        }
+
+        put(s.substr(run));
+    }
+
+    void writeJSON(const JobResult &r)
+    {
+        put("{\"jobId\": \"");
+        putEscaped(r.jobId);
+        put("\", \"category\": \"");
+        putEscaped(r.category.str());
+        put(r.success ? "\", \"success\": true, \"attempts\": " : "\", \"success\": false, \"attempts\": ");
+        putNumber(r.attempts);
+        put(", \"durationMs\": ");
+        putNumber(r.durationMs);
+
+        if (r.errorMessage.has_value())
+        {
+            put(", \"error\": \"");
+            putEscaped(*r.errorMessage);
+            put("\"");
+        }
+
+        put(", \"timestamp\": \"");
+        putNumber(static_cast<long long>(system_clock::to_time_t(r.endTime)));
+        put("\"}");
+    }
+
+    static uint64_t zigzag(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+    static int64_t unzigzag(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+    static size_t varintSize(uint64_t v)
+    {
+        size_t n = 1;
+        while (v >= 0x80)
+        {
+            v >>= 7;
+            ++n;
+        }
+        return n;
+    }
+
+    void putVarint(uint64_t v)
+    {
+        while (v >= 0x80)
+        {
+            put(static_cast<char>((v & 0x7f) | 0x80));
+            v >>= 7;
+        }
+        put(static_cast<char>(v));
+    }
+
+    void putText(string_view s)
+    {
+        putVarint(s.size());
+        put(s);
+    }
+
+    static int64_t micros(system_clock::time_point t)
+    {
+        return duration_cast<microseconds>(t.time_since_epoch()).count();
+    }
+
+    void writeBinary(const JobResult &r)
+    {
+        const string &id = r.jobId;
+        const string &category = r.category.str();
+        bool hasError = r.errorMessage.has_value();
+
+        uint64_t fields[] = {zigzag(r.attempts), zigzag(r.durationMs), zigzag(micros(r.startTime)), zigzag(micros(r.endTime))};
+
+        // Sized up front so the length prefix comes first
+        size_t length = 1 + varintSize(id.size()) + id.size() + varintSize(category.size()) + category.size();
+        for (uint64_t f : fields)
+            length += varintSize(f);
+        if (hasError)
+            length += varintSize(r.errorMessage->size()) + r.errorMessage->size();
+
+        putVarint(length);
+        put(static_cast<char>((r.success ? 1 : 0) | (hasError ? 2 : 0)));
+        for (uint64_t f : fields)
+            putVarint(f);
+        putText(id);
+        putText(category);
+        if (hasError)
+            putText(*r.errorMessage);
     }
 };
+
+inline string JobResult::toJSON() const
+{
+    // Escaping can at most multiply a string by six
+    size_t capacity = 160 + 6 * (jobId.size() + category.str().size() + (errorMessage ? errorMessage->size() : 0));
+    string json(capacity, '\0');
+
+    JobResultWriter writer(json);
+    writer.appendJSON(*this);
+    json.resize(writer.size());
+    return json;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Job.hh"
+#include "Worker.hh"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/*
+Serial executor for the jobs of one key (see JobDispatcher::dispatchKeyed)
+- jobs run one at a time, in the order they were pushed; the strand itself
+  runs as a job on any worker, so different strands spread across all of them
+- lock-free: producers push onto an intrusive stack (Job::strandNext) with a
+  CAS; the single drainer takes the stack whole and reverses it into FIFO order
+- `pending` counts queued jobs: the push that takes it from 0 to 1 has to
+  schedule drain(), which keeps running until it is 0 again, so exactly one
+  drain() is scheduled or running while jobs are pending
+*/
+class alignas(64) KeyedStrand
+{
+public:
+    KeyedStrand() = default;
+    KeyedStrand(const KeyedStrand &) = delete;
+    KeyedStrand &operator=(const KeyedStrand &) = delete;
+
+    ~KeyedStrand()
+    {
+        // Jobs never run, e.g. still queued at JobDispatcher::stop()
+        release(ready);
+        release(incoming.load(memory_order_acquire));
+    }
+
+    // Queues a job; returns true when the strand was idle and drain() must be scheduled
+    bool push(unique_ptr<Job> job)
+    {
+        Job *node = job.release();
+        node->strandNext = incoming.load(memory_order_relaxed);
+        while (!incoming.compare_exchange_weak(node->strandNext, node, memory_order_release, memory_order_relaxed))
+        {
+        }
+
+        return pending.fetch_add(1, memory_order_acq_rel) == 0;
+    }
+
+    // Runs up to `budget` jobs; returns true when more are pending and drain() must be scheduled again
+    bool drain(size_t budget)
+    {
+        for (size_t ran = 0; ran < budget; ++ran)
+        {
+            if (!ready)
+                ready = reverse(incoming.exchange(nullptr, memory_order_acquire));
+
+            unique_ptr<Job> job(ready);
+            ready = ready->strandNext;
+            job->strandNext = nullptr;
+
+            Worker::runJob(*job);
+            job.reset();
+
+            if (pending.fetch_sub(1, memory_order_acq_rel) == 1)
+                return false;
+        }
+
+        return true;
+    }
+
+private:
+    // Newest first, shared with producers
+    atomic<Job *> incoming{nullptr};
+    // Oldest first, owned by the drainer
+    Job *ready = nullptr;
+    atomic<size_t> pending{0};
+
+    static Job *reverse(Job *node)
+    {
+        Job *fifo = nullptr;
+        while (node)
+        {
+            Job *next = node->strandNext;
+            node->strandNext = fifo;
+            fifo = node;
+            node = next;
+        }
+        return fifo;
+    }
+
+    static void release(Job *node)
+    {
+        while (node)
+        {
+            Job *next = node->strandNext;
+            delete node;
+            node = next;
+        }
+    }
+};
@@ -0,0 +1,70 @@
+#include "NameRegistry.hh"
+
+#include <mutex>
+#include <stdexcept>
+
+NameTable::NameTable(string_view first, size_t maxNames)
+    : maxChunks((maxNames + chunkSize - 1) / chunkSize),
+      chunks(new atomic<string *>[maxChunks])
+{
+    for (size_t i = 0; i < maxChunks; ++i)
+        chunks[i].store(nullptr, memory_order_relaxed);
+
+    intern(first);
+}
+
+NameTable::~NameTable()
+{
+    for (size_t i = 0; i < maxChunks; ++i)
+        delete[] chunks[i].load(memory_order_relaxed);
+}
+
+uint32_t NameTable::intern(string_view name)
+{
+    {
+        shared_lock<shared_mutex> lock(mtx);
+        auto it = slots.find(name);
+        if (it != slots.end())
+            return it->second;
+    }
+
+    unique_lock<shared_mutex> lock(mtx);
+
+    // Interned by another thread between the two locks
+    auto it = slots.find(name);
+    if (it != slots.end())
+        return it->second;
+
+    uint32_t slot = count.load(memory_order_relaxed);
+    if (slot >= maxChunks * chunkSize)
+        throw length_error("NameTable: too many names");
+
+    atomic<string *> &chunk = chunks[slot / chunkSize];
+    string *names = chunk.load(memory_order_relaxed);
+    if (!names)
+    {
+        names = new string[chunkSize];
+        chunk.store(names, memory_order_release);
+    }
+
+    string &stored = names[slot % chunkSize];
+    stored = name;
+    slots.emplace(string_view(stored), slot);
+    count.store(slot + 1, memory_order_release);
+
+    return slot;
+}
+
+optional<uint32_t> NameTable::find(string_view name) const
+{
+    shared_lock<shared_mutex> lock(mtx);
+    auto it = slots.find(name);
+    if (it == slots.end())
+        return nullopt;
+    return it->second;
+}
+
+const string &NameTable::name(uint32_t slot) const
+{
+    return chunks[slot / chunkSize].load(memory_order_acquire)[slot % chunkSize];
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using namespace std;
+
+/*
+Process-wide interning table: every distinct name gets a dense small slot
+(0, 1, 2, ...) for the life of the process.
+- intern() takes a shared lock when the name is known, a unique lock the
+  first time it is seen
+- find() looks a name up without interning it, for names from untrusted input
+- name() is lock-free, and the reference it returns stays valid for good
+- slot 0 is the name given to the constructor
+- throws length_error past `maxNames` names: intern a small, closed set of
+  names (categories), never per-job values such as ids
+- name(slot) is unchecked: the slot must come from intern() on this table
+*/
+class NameTable
+{
+public:
+    NameTable(string_view first, size_t maxNames);
+    ~NameTable();
+
+    NameTable(const NameTable &) = delete;
+    NameTable &operator=(const NameTable &) = delete;
+
+    uint32_t intern(string_view name);
+    optional<uint32_t> find(string_view name) const;
+    const string &name(uint32_t slot) const;
+
+    // Names interned so far; valid slots are [0, size())
+    uint32_t size() const { return count.load(memory_order_acquire); }
+
+private:
+    static constexpr size_t chunkSize = 1024;
+
+    mutable shared_mutex mtx;
+    unordered_map<string_view, uint32_t> slots; // Views into the chunks
+    size_t maxChunks;
+    unique_ptr<atomic<string *>[]> chunks; // Names, `chunkSize` per chunk
+    atomic<uint32_t> count{0};
+};
+
+/*
+Handle to a name interned in the table of `Tag`: four bytes, copied and
+compared as an integer. Trackers index their metrics by slot(); str()
+resolves the name, for export and logging only.
+*/
+template <typename Tag>
+class InternedName
+{
+public:
+    static constexpr size_t maxNames = Tag::maxNames;
+
+    InternedName() = default; // Slot 0, Tag::first
+    InternedName(string_view name) : index(table().intern(name)) {}
+    InternedName(const string &name) : index(table().intern(name)) {}
+    InternedName(const char *name) : index(table().intern(name)) {}
+
+    // The name when already interned; never adds one
+    static optional<InternedName> find(string_view name)
+    {
+        optional<uint32_t> slot = table().find(name);
+        if (!slot)
+            return nullopt;
+        return fromSlot(*slot);
+    }
+
+    // `slot` must be one this table gave out (below table().size())
+    static InternedName fromSlot(uint32_t slot)
+    {
+        InternedName n;
+        n.index = slot;
+        return n;
+    }
+
+    uint32_t slot() const { return index; }
+    const string &str() const { return table().name(index); }
+
+    // Leaked on purpose: names may be resolved while statics are destroyed
+    static NameTable &table()
+    {
+        static NameTable *instance = new NameTable(Tag::first, Tag::maxNames);
+        return *instance;
+    }
+
+    friend bool operator==(InternedName a, InternedName b) { return a.index == b.index; }
+    friend bool operator!=(InternedName a, InternedName b) { return a.index != b.index; }
+    friend bool operator==(InternedName a, const char *b) { return a.str() == b; }
+    friend bool operator==(InternedName a, const string &b) { return a.str() == b; }
+
+    friend ostream &operator<<(ostream &os, InternedName n) { return os << n.str(); }
+
+private:
+    uint32_t index = 0;
+};
+
+struct CategoryTag
+{
+    static constexpr const char *first = "default";
+    static constexpr size_t maxNames = 1 << 16;
+};
+
+// Job categories, slot 0 is "default"
+using CategoryName = InternedName<CategoryTag>;
+
+/*
+Array of T indexed by interned slot, with chunks of `ChunkSize` allocated on
+first use: lookups are lock-free, and elements never move.
+*/
+template <typename T, size_t MaxSlots, size_t ChunkSize = 64>
+class SlotArray
+{
+public:
+    SlotArray() = default;
+    SlotArray(const SlotArray &) = delete;
+    SlotArray &operator=(const SlotArray &) = delete;
+
+    ~SlotArray()
+    {
+        for (auto &chunk : chunks)
+            delete[] chunk.load(memory_order_relaxed);
+    }
+
+    // Element for `slot`, default-constructed (with its whole chunk) the first time
+    T &operator[](uint32_t slot)
+    {
+        atomic<T *> &chunk = chunks[slot / ChunkSize];
+        T *elements = chunk.load(memory_order_acquire);
+        if (!elements)
+        {
+            T *fresh = new T[ChunkSize];
+            if (chunk.compare_exchange_strong(elements, fresh, memory_order_acq_rel))
+                elements = fresh;
+            else
+                delete[] fresh; // Another thread got there first
+        }
+
+        return elements[slot % ChunkSize];
+    }
+
+    // nullptr when the chunk for `slot` was never touched
+    const T *find(uint32_t slot) const
+    {
+        const T *elements = chunks[slot / ChunkSize].load(memory_order_acquire);
+        return elements ? &elements[slot % ChunkSize] : nullptr;
+    }
+
+private:
+    atomic<T *> chunks[(MaxSlots + ChunkSize - 1) / ChunkSize] = {};
+};
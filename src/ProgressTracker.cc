@@ -68,15 +68,15 @@ This function helps to track detailed data on work performance (by category), in
 - Total number of completed jobs,
 - Warning when detecting jobs with high latency.
 */
-void ProgressTracker::markJobDoneWithCategory(const string &category, int latencyMs, LogLevel level)
+void ProgressTracker::markJobDoneWithCategory(CategoryName category, int latencyMs, LogLevel level)
 {
-    // Update category statistics
+    // Update category statistics, including the counts by level
     {
-        auto &metric = categoryMetrics[category];
+        auto &metric = categoryMetrics[category.slot()];
         lock_guard<mutex> lock(metric.mtx_);
         metric.latencies.push_back(latencyMs);
 
-        metric.lvlCount[level]++;
+        metric.lvlCount[static_cast<size_t>(level)]++;
 
         if (latencyMs < metric.minLatency)
             metric.minLatency = latencyMs;
@@ -87,17 +87,11 @@ void ProgressTracker::markJobDoneWithCategory(const string &category, int latenc
         metric.count++;
     }
 
-    // Update overall statistics for each category by level
-    {
-        lock_guard<mutex> lock(levelCountMutex);
-        categoryLevelCounts[category][level]++;
-    }
-
     totalDone++;
 
     if (highlightThreshold > 0 && latencyMs > highlightThreshold)
     {
-        Logger::dualSafeLog(colorText("[!!!] High latency job (" + category + "): " + to_string(latencyMs) + "ms", "31"));
+        Logger::dualSafeLog(colorText("[!!!] High latency job (" + category.str() + "): " + to_string(latencyMs) + "ms", "31"));
     }
 }
 
@@ -210,8 +204,8 @@ json ProgressTracker::exportSummaryJSON()
     json categoriesJson = json::object(); // The child JSON contains only data by category
 
     // Record information for each category
-    for (const auto &[category, metric] : categoryMetrics)
-    {
+    forEachCategory([&](const string &category, const CategoryMetric &metric)
+                    {
         lock_guard<mutex> lock(metric.mtx_);
 
         categoriesJson[category] = {
@@ -219,7 +213,7 @@ json ProgressTracker::exportSummaryJSON()
             {"average_latency_ms", metric.latencies.empty() ? 0 : accumulate(metric.latencies.begin(), metric.latencies.end(), 0) / (int)metric.latencies.size()},
             {"min_latency_ms", metric.minLatency},
             {"max_latency_ms", metric.maxLatency}};
-    }
+    });
 
     j["categories"] = categoriesJson;
     j["levelSummary"] = exportLevelSummaryJSON();
@@ -240,8 +234,8 @@ string ProgressTracker::exportPrometheus() const
     int expectedTotal = 0;
 
     // Browse each category group
-    for (const auto &[category, metric] : categoryMetrics)
-    {
+    forEachCategory([&](const string &category, const CategoryMetric &metric)
+                    {
         lock_guard<mutex> lock(metric.mtx_);
 
         // Calculate total latency and count buckets
@@ -284,7 +278,7 @@ string ProgressTracker::exportPrometheus() const
         // Export total delay and quantity
         ss << "job_latency_sum{category=\"" << category << "\"} " << latencySum << "\n";
         ss << "job_latency_count{category=\"" << category << "\"} " << count << "\n";
-    }
+    });
 
     // Overall data (all categories)
     ss << "job_total_done " << totalDone.load() << "\n";
@@ -301,8 +295,8 @@ string ProgressTracker::exportJSON() const
     root["total_done"] = totalDone.load();
     json categories = json::object();
 
-    for (const auto &[category, metric] : categoryMetrics)
-    {
+    forEachCategory([&](const string &category, const CategoryMetric &metric)
+                    {
         lock_guard<mutex> lock(metric.mtx_);
 
         int sum = 0; // Total latency
@@ -321,7 +315,7 @@ string ProgressTracker::exportJSON() const
             {"average_latency_ms", avg},
             {"min_latency_ms", metric.minLatency},
             {"max_latency_ms", metric.maxLatency}};
-    }
+    });
 
     // Write aggregate data to JSON
     root["total_expected"] = expectedTotal;
@@ -354,18 +348,22 @@ Print a summary table of log counts by category and level
 */
 void ProgressTracker::printLevelSummary()
 {
-    lock_guard<mutex> lock(levelCountMutex);
     Logger::dualSafeLog("\n\n\t ========================== Log Level Summary ========================== \n");
 
-    for (const auto &[category, levelMap] : categoryLevelCounts)
-    {
+    forEachCategory([&](const string &category, const CategoryMetric &metric)
+                    {
         Logger::dualSafeLog("Category: " + category);
 
-        for (const auto &[level, count] : levelMap)
+        lock_guard<mutex> lock(metric.mtx_);
+        for (size_t lvl = 0; lvl < metric.lvlCount.size(); ++lvl)
         {
+            int count = metric.lvlCount[lvl];
+            if (count == 0)
+                continue;
+
             string levelStr;
 
-            switch (level)
+            switch (static_cast<LogLevel>(lvl))
             {
             case LogLevel::Info:
                 levelStr = "INFO";
@@ -385,21 +383,24 @@ void ProgressTracker::printLevelSummary()
             }
 
             Logger::dualSafeLog("  - " + levelStr + ": " + to_string(count));
-        }
-    }
+        } });
 }
 
 json ProgressTracker::exportLevelSummaryJSON()
 {
-    lock_guard<mutex> lock(levelCountMutex);
     json j;
 
-    for (const auto &[category, levelMap] : categoryLevelCounts)
-    {
-        for (const auto &[level, count] : levelMap)
+    forEachCategory([&](const string &category, const CategoryMetric &metric)
+                    {
+        lock_guard<mutex> lock(metric.mtx_);
+        for (size_t lvl = 0; lvl < metric.lvlCount.size(); ++lvl)
         {
+            int count = metric.lvlCount[lvl];
+            if (count == 0)
+                continue;
+
             string levelStr;
-            switch (level)
+            switch (static_cast<LogLevel>(lvl))
             {
             case LogLevel::Info:
                 levelStr = "INFO";
@@ -419,8 +420,7 @@ json ProgressTracker::exportLevelSummaryJSON()
             }
 
             j[category][levelStr] = count;
-        }
-    }
+        } });
 
     return j;
 }
@@ -3,9 +3,11 @@
 #include <chrono>
 #include <functional>
 #include <vector>
+#include <array>
 #include <atomic>
 
 #include "Logger.hh"
+#include "NameRegistry.hh"
 
 // #include <nlohmann/json.hpp> // JSON export
 #include "../third_party/json-src/single_include/nlohmann/json.hpp" // JSON export
@@ -25,9 +27,9 @@ struct JobMetric
 // Manage statistics by group
 struct CategoryMetric
 {
-    vector<int> latencies;                 // Latency History
-    unordered_map<LogLevel, int> lvlCount; // count by LogLevel
-    atomic<int> count{0};                  // Count total logs
+    vector<int> latencies;        // Latency History
+    array<int, 4> lvlCount{};     // count by LogLevel, indexed by its value
+    atomic<int> count{0};         // Count total logs
     mutable mutex mtx_;
     int minLatency = INT_MAX;
     int maxLatency = INT_MIN;
@@ -63,7 +65,8 @@ public:
 
     // status updates, latency statistics and log levels
     void markJobDone(int latencyMs, LogLevel level);
-    void markJobDoneWithCategory(const string &category, int latencyMs, LogLevel level);
+    // Strings are interned on every call: pass a CategoryName kept by the caller on hot paths
+    void markJobDoneWithCategory(CategoryName category, int latencyMs, LogLevel level);
     void updateProgress();
     void finish();
 
@@ -116,14 +119,23 @@ private:
 
     string colorText(const string &text, const string &colorCode) const;
 
-    // Statistics by job type
-    unordered_map<string, CategoryMetric> categoryMetrics;
+    // Statistics by job type, indexed by CategoryName slot
+    SlotArray<CategoryMetric, CategoryName::maxNames> categoryMetrics;
+
+    // Calls f(name, metric) for every category this tracker has seen, in slot order
+    template <typename F>
+    void forEachCategory(F f) const
+    {
+        uint32_t names = CategoryName::table().size();
+        for (uint32_t slot = 0; slot < names; ++slot)
+        {
+            const CategoryMetric *metric = categoryMetrics.find(slot);
+            if (metric && metric->count.load() > 0)
+                f(CategoryName::fromSlot(slot).str(), *metric);
+        }
+    }
     Callback callback;
     atomic<int> totalDone{0}; // total number of actual jobs processed
 
     const vector<int> latencyBuckets = {50, 100, 250, 500, 1000};
-
-    // Number of logs by category and log level
-    unordered_map<string, unordered_map<LogLevel, int>> categoryLevelCounts;
-    mutex levelCountMutex;
 };
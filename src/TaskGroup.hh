@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Worker.hh"
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <utility>
+
+/*
+Cilk-style fork-join for job bodies.
+- spawn(fn) pushes fn as a strand onto the calling worker's own queue, where
+  idle workers can steal it
+- sync() waits for every strand spawned so far; while waiting, the thread runs
+  jobs from its own queue (newest first, usually its own strands) and steals
+  from the other workers instead of blocking, so recursive divide-and-conquer
+  never needs more threads than the dispatcher has
+- the first exception thrown by a strand is rethrown by sync()
+Off the dispatcher's workers there is nothing to help with: spawn() runs fn
+inline (the serial elision) and sync() only rethrows.
+A group is used by a single thread: spawn() and sync() must be called from the
+thread that created it. Groups nest freely, a strand may open its own group.
+*/
+class TaskGroup
+{
+public:
+    TaskGroup() = default;
+
+    // Strands refer to the group: wait for them, but errors left unsynced are dropped
+    ~TaskGroup()
+    {
+        waitForStrands();
+    }
+
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    template <typename F>
+    void spawn(F &&fn)
+    {
+        Worker *worker = Worker::current();
+        if (!worker)
+        {
+            runStrand(fn);
+            return;
+        }
+
+        pending.fetch_add(1, memory_order_relaxed);
+
+        auto strand = make_unique<Job>();
+        strand->spawned = true;
+        strand->tasks = [this, fn = std::forward<F>(fn)]() mutable
+        {
+            runStrand(fn);
+            pending.fetch_sub(1, memory_order_release); // The group may be gone after this
+        };
+
+        worker->push(std::move(strand));
+    }
+
+    // Wait for every spawned strand, then rethrow the first exception any of them threw
+    void sync()
+    {
+        waitForStrands();
+
+        if (failed.load(memory_order_acquire))
+        {
+            failed.store(false, memory_order_relaxed);
+            rethrow_exception(std::exchange(firstError, nullptr));
+        }
+    }
+
+    // Strands spawned and not finished yet
+    size_t pendingCount() const { return pending.load(memory_order_acquire); }
+
+private:
+    atomic<size_t> pending{0};
+    atomic<bool> failed{false};
+    exception_ptr firstError;
+
+    template <typename F>
+    void runStrand(F &fn)
+    {
+        try
+        {
+            fn();
+        }
+        catch (...)
+        {
+            if (!failed.exchange(true, memory_order_acq_rel))
+                firstError = current_exception();
+        }
+    }
+
+    // Help instead of blocking: run local or stolen jobs until the strands are done
+    void waitForStrands()
+    {
+        Worker *worker = Worker::current();
+
+        while (pending.load(memory_order_acquire) != 0)
+        {
+            if (!worker || !worker->runOne())
+                this_thread::yield();
+        }
+    }
+};
@@ -0,0 +1,308 @@
+#pragma once
+
+#include "Job.hh"
+
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/*
+Policies of a TypedJob: each adds one callback (or setting), stored by value.
+A TypedJob without a policy does not carry the member and skips the code that
+would use it, e.g. no clock reads without OnResult / OnComplete.
+*/
+template <typename F>
+struct OnStart
+{
+    [[no_unique_address]] F onStart;
+};
+
+template <typename F>
+struct OnError
+{
+    [[no_unique_address]] F onError; // void(const string &error)
+};
+
+template <typename F>
+struct OnResult
+{
+    [[no_unique_address]] F onResult; // void(const JobResult &)
+};
+
+template <typename F>
+struct OnComplete
+{
+    [[no_unique_address]] F onComplete; // void(bool success, int attempts, long long durationMs)
+};
+
+// Called last, with the result and the task's return value moved in
+template <typename F>
+struct OnValue
+{
+    [[no_unique_address]] F onValue; // void(JobResultOf<T> &&)
+};
+
+// Retry the task up to `count` more times when it throws
+struct Retry
+{
+    int count = 0;
+};
+
+namespace typed_job_detail
+{
+    template <template <typename> class P, typename T>
+    inline constexpr bool isPolicy = false;
+
+    template <template <typename> class P, typename F>
+    inline constexpr bool isPolicy<P, P<F>> = true;
+
+    template <template <typename> class P, typename... Policies>
+    inline constexpr int count = (0 + ... + (isPolicy<P, Policies> ? 1 : 0));
+
+    template <template <typename> class P, typename... Policies>
+    inline constexpr bool has = count<P, Policies...> > 0;
+
+    // Stands in for the result when no callback wants one
+    struct NoResult
+    {
+    };
+}
+
+/*
+Pooled Job node holding a TypedJob by value: its task only points back at the
+job, so the task fits inline and node and job share one JobPool block.
+Workers call tasks() directly. The node must stay where it is (it is never
+moved out of its unique_ptr<Job>).
+*/
+template <typename T>
+struct TypedJobNode final : Job
+{
+    T typed;
+
+    explicit TypedJobNode(T &&job) : typed(std::move(job))
+    {
+        tasks = [this]
+        { typed.run(); };
+        spawned = true;
+    }
+};
+
+/*
+Job whose task and callbacks keep their own types: calls are direct and
+inlinable, and only the callbacks given as Policies exist.
+- run() does what JobExecutor does for a Job, minus timeouts and logging:
+  onStart, attempts with retries, onError per failure, then onResult / onComplete
+- a task may return a value: it is moved into a JobResultOf<T> for OnValue
+  (or the JobHandle JobDispatcher::submit returns), and dropped without one
+- dispatched through JobDispatcher it is type-erased once, into a pooled Job
+  node that stores it by value and that workers call directly (see toJob)
+- build one with JobBuilder::typed()
+*/
+template <typename F, typename... Policies>
+struct TypedJob : Policies...
+{
+    [[no_unique_address]] F task;
+    string id;             // Only read for onResult
+    CategoryName category; // Only read for onResult
+
+    static constexpr bool hasStart = typed_job_detail::has<OnStart, Policies...>;
+    static constexpr bool hasError = typed_job_detail::has<OnError, Policies...>;
+    static constexpr bool hasResult = typed_job_detail::has<OnResult, Policies...>;
+    static constexpr bool hasComplete = typed_job_detail::has<OnComplete, Policies...>;
+    static constexpr bool hasValue = typed_job_detail::has<OnValue, Policies...>;
+    static constexpr bool hasRetry = (is_same_v<Policies, Retry> || ...);
+    static constexpr bool reports = hasResult || hasValue;
+    static constexpr bool timed = reports || hasComplete;
+
+    using Value = invoke_result_t<F &>;
+    using Result = JobResultOf<Value>;
+
+    static_assert(typed_job_detail::count<OnStart, Policies...> <= 1 && typed_job_detail::count<OnError, Policies...> <= 1 &&
+                      typed_job_detail::count<OnResult, Policies...> <= 1 && typed_job_detail::count<OnComplete, Policies...> <= 1 &&
+                      typed_job_detail::count<OnValue, Policies...> <= 1 &&
+                      (0 + ... + (is_same_v<Policies, Retry> ? 1 : 0)) <= 1,
+                  "TypedJob: each callback / setting can be given once");
+
+    // Returns whether an attempt succeeded
+    bool run()
+    {
+        if constexpr (hasStart)
+            this->onStart();
+
+        [[maybe_unused]] conditional_t<reports, Result, typed_job_detail::NoResult> result;
+        [[maybe_unused]] chrono::steady_clock::time_point start;
+        if constexpr (timed)
+        {
+            start = chrono::steady_clock::now();
+            if constexpr (reports)
+                result.startTime = system_clock::now();
+        }
+
+        int retries = 0;
+        if constexpr (hasRetry)
+            retries = static_cast<const Retry &>(*this).count;
+
+        bool success = false;
+        int attempts = 0;
+        [[maybe_unused]] string errorMessage;
+
+        for (; attempts <= retries && !success; ++attempts)
+        {
+            try
+            {
+                if constexpr (hasValue && !is_void_v<Value>)
+                    result.value.emplace(task());
+                else
+                    task();
+                success = true;
+            }
+            catch (const exception &e)
+            {
+                if constexpr (hasError || reports)
+                    errorMessage = e.what();
+            }
+            catch (...)
+            {
+                if constexpr (hasError || reports)
+                    errorMessage = "Unknown exception";
+            }
+
+            if constexpr (hasError)
+            {
+                if (!success)
+                    this->onError(errorMessage);
+            }
+        }
+
+        if constexpr (timed)
+        {
+            long long durationMs = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+
+            if constexpr (reports)
+            {
+                result.success = success;
+                result.attempts = attempts;
+                result.durationMs = durationMs;
+                result.jobId = id;
+                result.category = category;
+                result.endTime = system_clock::now();
+                if (!success)
+                    result.errorMessage = std::move(errorMessage);
+            }
+
+            if constexpr (hasResult)
+                this->onResult(static_cast<const JobResult &>(result));
+
+            if constexpr (hasComplete)
+                this->onComplete(success, attempts, durationMs);
+
+            if constexpr (hasValue)
+                this->onValue(std::move(result));
+        }
+
+        return success;
+    }
+
+    // The same job with one more policy
+    template <typename P>
+    TypedJob<F, Policies..., P> with(P policy) &&
+    {
+        return {static_cast<Policies &&>(*this)..., std::move(policy), std::move(task), id, category};
+    }
+
+    // Whether toJob() fits the job in one JobPool block; otherwise it is moved to the heap
+    static constexpr bool pooled()
+    {
+        return sizeof(TypedJobNode<TypedJob>) <= JobPool::maxBlockSize(sizeof(Job)) &&
+               alignof(TypedJobNode<TypedJob>) <= alignof(Job);
+    }
+
+    // The one type erasure: a pooled Job node that runs this job
+    unique_ptr<Job> toJob() &&
+    {
+        if constexpr (pooled())
+            return make_unique<TypedJobNode<TypedJob>>(std::move(*this));
+        else
+        {
+            auto job = make_unique<Job>([typed = std::move(*this)]() mutable
+                                        { typed.run(); });
+            job->spawned = true; // Workers call tasks() directly: run() does the rest
+            return job;
+        }
+    }
+};
+
+/*
+Builder for TypedJob, returned by JobBuilder::typed(). Every callback added
+returns a builder of a new type and moves the policies so far into it (this
+builder is left empty); build(task) produces the job.
+*/
+template <typename... Policies>
+class TypedJobBuilder
+{
+public:
+    TypedJobBuilder() = default;
+    TypedJobBuilder(tuple<Policies...> policies, string id, CategoryName category)
+        : policies(std::move(policies)), id(std::move(id)), category(category) {}
+
+    TypedJobBuilder &withId(string jobId)
+    {
+        id = std::move(jobId);
+        return *this;
+    }
+
+    TypedJobBuilder &withCategory(CategoryName cat)
+    {
+        category = cat;
+        return *this;
+    }
+
+    auto withRetry(int count) { return add(Retry{count}); }
+
+    template <typename G>
+    auto onStart(G callback) { return add(OnStart<G>{std::move(callback)}); }
+
+    template <typename G>
+    auto onError(G callback) { return add(OnError<G>{std::move(callback)}); }
+
+    template <typename G>
+    auto onResult(G callback) { return add(OnResult<G>{std::move(callback)}); }
+
+    template <typename G>
+    auto onComplete(G callback) { return add(OnComplete<G>{std::move(callback)}); }
+
+    template <typename G>
+    auto onValue(G callback) { return add(OnValue<G>{std::move(callback)}); }
+
+    // Copies the policies, so one builder can stamp many jobs
+    template <typename F>
+    TypedJob<F, Policies...> build(F task) const &
+    {
+        return apply([&](const Policies &...p)
+                     { return TypedJob<F, Policies...>{p..., std::move(task), id, category}; },
+                     policies);
+    }
+
+    template <typename F>
+    TypedJob<F, Policies...> build(F task) &&
+    {
+        return apply([&](Policies &...p)
+                     { return TypedJob<F, Policies...>{std::move(p)..., std::move(task), id, category}; },
+                     policies);
+    }
+
+private:
+    tuple<Policies...> policies;
+    string id;
+    CategoryName category;
+
+    template <typename P>
+    TypedJobBuilder<Policies..., P> add(P policy)
+    {
+        return {tuple_cat(std::move(policies), tuple<P>(std::move(policy))), id, category};
+    }
+};
@@ -1,10 +1,15 @@
-
 #include "WorkStealing.hh"
 #include "log_utils.h"
 
+thread_local WorkStealingThreadPool *WorkStealingThreadPool::currentPool = nullptr;
+thread_local size_t WorkStealingThreadPool::currentIndex = 0;
+
 WorkStealingThreadPool::WorkStealingThreadPool(size_t threadCount)
-    : done(false), rng(random_device{}())
+    : done(false)
 {
+    if (threadCount == 0)
+        threadCount = 1;
+
     for (size_t i = 0; i < threadCount; ++i)
     {
         queues.emplace_back(make_unique<Queue>());
@@ -19,10 +24,12 @@ WorkStealingThreadPool::WorkStealingThreadPool(size_t threadCount)
 
 WorkStealingThreadPool::~WorkStealingThreadPool()
 {
-    done = true; // Signal all worker threads to stop
+    {
+        lock_guard<mutex> lock(idleMutex);
+        done = true; // Signal all worker threads to stop
+    }
 
-    for (auto &q : queues)
-        q->cv.notify_all(); // Wake up threads that may be waiting for work
+    idleCV.notify_all(); // Wake up threads that may be waiting for work
 
     for (auto &t : threads)
         t.join(); // Make sure all threads actually terminate
@@ -35,16 +42,118 @@ void WorkStealingThreadPool::enqueue(Task<void> task)
 {
     activeTasks++; // increase the count of running tasks
 
-    // Choose a random queue (round-robin or random) in pool to put the task into
-    size_t index = dist(rng) % queues.size();
+    schedule(runOwned(std::move(task)).handle);
+}
+
+void WorkStealingThreadPool::schedule(coroutine_handle<> handle)
+{
+    if (currentPool == this)
+        push(currentIndex, handle);
+    else
+        push(nextQueue.fetch_add(1, memory_order_relaxed) % queues.size(), handle);
+}
+
+void WorkStealingThreadPool::scheduleOn(size_t worker, coroutine_handle<> handle)
+{
+    push(worker % queues.size(), handle);
+}
+
+/*
+Keeps an enqueued task alive until it completes, then updates the active count
+*/
+DetachedTask WorkStealingThreadPool::runOwned(Task<void> task)
+{
+    try
+    {
+        co_await task; // wait for the task to actually complete
+    }
+    catch (const exception &e)
+    {
+        SAFE_CERR("[ThreadPool] Task failed: " << e.what() << "\n");
+    }
+    catch (...)
+    {
+        SAFE_CERR("[ThreadPool] Task failed: unknown exception\n");
+    }
+
+    if (--activeTasks == 0)
+    {
+        lock_guard<mutex> lock(doneMutex);
+        allDoneCV.notify_all(); // Tell waitAll() that all work is done.
+    }
+}
+
+void WorkStealingThreadPool::push(size_t index, coroutine_handle<> handle)
+{
     {
         lock_guard<mutex> lock(queues[index]->mtx);
-        queues[index]->tasks.push(std::move(task));
+        queues[index]->tasks.push_back(handle);
     }
 
-    // Signals to a thread waiting on that queue (if any) that new work has
-    // arrived. thread wakes up and starts processing task
-    queues[index]->cv.notify_one();
+    pending.fetch_add(1);
+
+    // Only pay for the idle lock when someone is actually parked
+    if (sleepers.load() > 0)
+    {
+        lock_guard<mutex> lock(idleMutex);
+        idleCV.notify_one();
+    }
+}
+
+/*
+Take work for worker `index`: newest item from its own queue first (hot in cache),
+otherwise the oldest item from another worker's queue
+*/
+bool WorkStealingThreadPool::popTask(size_t index, coroutine_handle<> &handle)
+{
+    {
+        auto &own = *queues[index];
+        lock_guard<mutex> lock(own.mtx);
+
+        if (!own.tasks.empty())
+        {
+            handle = own.tasks.back();
+            own.tasks.pop_back();
+            pending.fetch_sub(1);
+            return true;
+        }
+    }
+
+    for (size_t offset = 1; offset < queues.size(); ++offset)
+    {
+        auto &victim = *queues[(index + offset) % queues.size()];
+        lock_guard<mutex> lock(victim.mtx);
+
+        if (!victim.tasks.empty())
+        {
+            handle = victim.tasks.front();
+            victim.tasks.pop_front();
+            pending.fetch_sub(1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool WorkStealingThreadPool::runPending()
+{
+    coroutine_handle<> handle;
+    if (currentPool != this || !popTask(currentIndex, handle))
+        return false;
+
+    handle.resume();
+    return true;
+}
+
+bool WorkStealingThreadPool::localQueueEmpty()
+{
+    if (currentPool != this)
+        return true;
+
+    auto &own = *queues[currentIndex];
+    lock_guard<mutex> lock(own.mtx);
+    return own.tasks.empty();
 }
 
 void WorkStealingThreadPool::printStatus()
@@ -67,86 +176,39 @@ void WorkStealingThreadPool::waitAll()
                    { return activeTasks.load() == 0; });
 }
 
-// void WorkStealingThreadPool::workerLoop(size_t index)
-// {
-//     while (!done)
-//     {
-//         optional<Task<void>> taskOpt; // avoid deleted default constructor
-//         bool found = false;
-
-//         for (size_t offset = 0; offset < queues.size(); ++offset)
-//         {
-//             size_t i = (index + offset) % queues.size();
-//             auto &q = *queues[i];
-//             unique_lock lock(q.mtx);
-
-//             if (!q.tasks.empty())
-//             {
-//                 taskOpt = std::move(q.tasks.front());
-//                 q.tasks.pop();
-//                 found = true;
-//                 break;
-//             }
-//         }
-
-//         if (found && taskOpt.has_value())
-//         {
-//             taskOpt->handle.resume();
-//         }
-//         else
-//         {
-//             auto &q = *queues[index];
-//             unique_lock lock(q.mtx);
-//             q.cv.wait_for(lock, chrono::milliseconds(100));
-//         }
-//     }
-// }
-
 /*
 Controls the work loop of each thread in the WorkStealingThreadPool
 */
 void WorkStealingThreadPool::workerLoop(size_t index)
 {
-    while (!done)
-    {
-        Task<void> task;
-
-        {
-            // Lock the queue corresponding to the thread index
-            unique_lock<mutex> lock(queues[index]->mtx);
-
-            // wait when: there is a new task or thread pool is stopped
-            queues[index]->cv.wait(lock, [&]
-                                   { return done || !queues[index]->tasks.empty(); });
+    currentPool = this;
+    currentIndex = index;
 
-            // If done == true and queue is empty → no more work to do → exit the loop
-            if (done && queues[index]->tasks.empty())
-                return;
+    // Blocking Task waits on this thread keep the worker busy instead of parking it
+    current_wait_helper = {[](void *pool)
+                           { return static_cast<WorkStealingThreadPool *>(pool)->runPending(); },
+                           this};
 
-            task = std::move(queues[index]->tasks.front());
-            queues[index]->tasks.pop();
-        }
+    while (true)
+    {
+        coroutine_handle<> handle;
 
-        // Wrap the task to reduce the count when completed (attach task counting logic to root task)
-        auto wrapped = [this, task = std::move(task)]() mutable -> Task<void>
+        if (popTask(index, handle))
         {
-            co_await task; // wait for the task to actually complete
-
-            if (--activeTasks == 0)
-            {
-                lock_guard<mutex> lock(doneMutex);
-                allDoneCV.notify_all(); // Tell waitAll() that all work is done.
-            }
+            handle.resume(); // Runs until the coroutine finishes or suspends again
+            continue;
+        }
 
-            co_return;
-        };
+        unique_lock<mutex> lock(idleMutex);
 
-        // Now run the wrapped coroutine properly until completion
-        auto wrappedTask = wrapped();
+        // If done == true and nothing is queued anywhere → no more work to do → exit the loop
+        if (done && pending.load() == 0)
+            return;
 
-        while (!wrappedTask.handle.done())
-        {
-            wrappedTask.handle.resume();
-        }
+        // wait when: there is a new task or thread pool is stopped
+        sleepers++;
+        idleCV.wait(lock, [this]
+                    { return done || pending.load() > 0; });
+        sleepers--;
     }
 }
@@ -3,20 +3,53 @@
 #include "task.hh"
 
 #include <condition_variable>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <queue>
-#include <random>
 #include <thread>
 
 using namespace std;
 
+/*
+Wrap a callable into a Task<void>.
+- If the callable returns an awaitable (e.g. another Task), it is awaited, so the
+  wrapped coroutine only completes when the inner one does.
+- Taken by value: the task is lazy, the callable must outlive the call site.
+*/
 template <typename F>
-Task<void> wrapAsTask(F &&f)
+Task<void> wrapAsTask(F f)
 {
-    f();       // Call function F immediately
-    co_return; // Returns a coroutine that does nothing (of type Task<void>)
+    if constexpr (Awaitable<invoke_result_t<F &>>)
+        co_await f();
+    else
+        f(); // Call function F when the task runs
+
+    co_return;
 }
 
+/*
+Fire-and-forget coroutine used by the pool to own enqueued tasks:
+starts suspended, destroys itself when it finishes.
+*/
+struct DetachedTask
+{
+    struct promise_type
+    {
+        DetachedTask get_return_object() noexcept
+        {
+            return {coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        suspend_always initial_suspend() noexcept { return {}; }
+        suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { terminate(); }
+    };
+
+    coroutine_handle<promise_type> handle;
+};
+
 class WorkStealingThreadPool
 {
 public:
@@ -27,11 +60,57 @@ public:
     template <typename F>
     void enqueue(Task<F> task)
     {
-        enqueue(wrapAsTask(std::move(task)));
+        enqueue(wrapAsTask([task = std::move(task)]() mutable
+                           { return std::move(task); }));
     }
 
+    // The pool takes ownership of the task and keeps it alive until it completes
     void enqueue(Task<void> task);
 
+    /*
+    Resume a coroutine on one of the workers (the pool does not own it).
+    Called from a worker, the coroutine goes to that worker's own queue so the
+    data it touches stays in the same cache; idle workers steal it otherwise.
+    */
+    void schedule(coroutine_handle<> handle);
+
+    // Resume a coroutine from worker `worker`'s queue (other workers may still steal it)
+    void scheduleOn(size_t worker, coroutine_handle<> handle);
+
+    // Index of the calling worker in this pool, SIZE_MAX when called from any other thread
+    size_t currentWorker() const { return currentPool == this ? currentIndex : SIZE_MAX; }
+
+    // `co_await pool.schedule()` continues the awaiting coroutine on a pool worker
+    auto schedule()
+    {
+        struct Awaiter
+        {
+            WorkStealingThreadPool *pool;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(coroutine_handle<> h) { pool->schedule(h); }
+            void await_resume() const noexcept {}
+        };
+
+        return Awaiter{this};
+    }
+
+    size_t size() const { return queues.size(); }
+
+    /*
+    Resume one queued coroutine on the calling worker: its own newest item, or one
+    stolen from another worker. False off the pool or when nothing is queued.
+    Blocking waits on a worker call this through current_wait_helper.
+    */
+    bool runPending();
+
+    /*
+    True when the calling worker's own queue is empty, i.e. thieves have taken
+    everything it offered. Lazy splitting uses it as the demand signal: work is
+    only split off while other workers could pick it up. True off the pool.
+    */
+    bool localQueueEmpty();
+
     void printStatus();
 
     void waitAll();
@@ -40,20 +119,31 @@ private:
     struct Queue
     {
         mutex mtx;
-        condition_variable cv;
-        queue<Task<void>> tasks; // Queue containing pending tasks
+        deque<coroutine_handle<>> tasks; // Owner pops the back, thieves take the front
     };
 
     vector<unique_ptr<Queue>> queues; // Each worker thread has its own queue
     vector<thread> threads;           // List of worker threads
     atomic<bool> done;                // Mark if pool has been requested to stop
-    mt19937 rng;                      // Random number generator for queue selection
-    uniform_int_distribution<> dist;  // Random distribution to select queue
+    atomic<size_t> nextQueue{0};      // Round-robin target for work submitted from outside
 
     atomic<int> activeTasks{0}; // count the number of active tasks
     // condition_variable_any allDoneCV;
     condition_variable allDoneCV; // Notified when `activeTasks == 0`
     mutex doneMutex;              // Protect `allDoneCV` when waiting or notifying
 
+    // Idle workers park here until something is pushed to any queue
+    atomic<size_t> pending{0}; // Queued coroutines not yet picked up
+    atomic<int> sleepers{0};   // Workers currently parked
+    mutex idleMutex;
+    condition_variable idleCV;
+
+    // Which pool/worker the current thread belongs to (nullptr outside the pool)
+    static thread_local WorkStealingThreadPool *currentPool;
+    static thread_local size_t currentIndex;
+
+    DetachedTask runOwned(Task<void> task);
+    void push(size_t index, coroutine_handle<> handle);
+    bool popTask(size_t index, coroutine_handle<> &handle);
     void workerLoop(size_t index);
-};
\ No newline at end of file
+};
@@ -2,9 +2,19 @@
 #include "JobExecutor.hh"
 
 #include <memory>
+#include <utility>
 
-Worker::Worker(LockFreeDeque<Job> &localQueue, vector<LockFreeDeque<Job> *> &all)
-    : queues(localQueue), allQueues(all)
+namespace
+{
+    thread_local Worker *currentWorker = nullptr;
+
+    // See Worker::defer
+    thread_local const void *deferredGroup = nullptr;
+    thread_local void (*deferredFlush)() = nullptr;
+}
+
+Worker::Worker(LockFreeDeque<Job> &localQueue, vector<LockFreeDeque<Job> *> &all, JobFeed *feed)
+    : queues(localQueue), allQueues(all), feed(feed)
 {
     start();
 }
@@ -25,14 +35,72 @@ void Worker::join()
         threads.join();
 }
 
+Worker *Worker::current()
+{
+    return currentWorker;
+}
+
+void Worker::push(unique_ptr<Job> job)
+{
+    queues.pushBottom(std::move(job));
+}
+
+bool Worker::runOne()
+{
+    unique_ptr<Job> job;
+    if (!queues.popBottom(job) && !(refill() && queues.popBottom(job)) && !steal(job))
+        return false;
+
+    runJob(*job);
+    return true;
+}
+
+void Worker::runJob(Job &job)
+{
+    if (deferredFlush && job.group != deferredGroup)
+        flushDeferred();
+
+    if (job.spawned)
+        job.tasks(); // Strands (TaskGroup) and TypedJob nodes handle their own exceptions
+    else
+        JobExecutor::execute(job);
+}
+
+void Worker::defer(const void *group, void (*flush)())
+{
+    if (deferredFlush && group != deferredGroup)
+        flushDeferred();
+
+    deferredGroup = group;
+    deferredFlush = flush;
+}
+
+void Worker::flushDeferred()
+{
+    if (auto flush = std::exchange(deferredFlush, nullptr))
+    {
+        deferredGroup = nullptr;
+        flush();
+    }
+}
+
 void Worker::run()
 {
+    currentWorker = this;
+    int idleRounds = 0;
+
     while (running)
     {
-        unique_ptr<Job> job;
-        if (queues.popBottom(job) || steal(job))
+        if (runOne())
         {
-            JobExecutor::execute(*job);
+            idleRounds = 0;
+        }
+        else if (++idleRounds < 64)
+        {
+            if (idleRounds == 1)
+                flushDeferred(); // Nothing left to run: settle what the last jobs deferred
+
+            this_thread::yield(); // Stay responsive to freshly spawned strands for a while
         }
         else
         {
@@ -40,6 +108,22 @@ void Worker::run()
             this_thread::sleep_for(chrono::milliseconds(10));
         }
     }
+
+    flushDeferred();
+    currentWorker = nullptr;
+}
+
+bool Worker::refill()
+{
+    if (!feed || !feed->hasWork() || feed->pull(pulled) == 0)
+        return false;
+
+    // Reversed: popBottom then runs the batch in the order the source produced it
+    for (auto it = pulled.rbegin(); it != pulled.rend(); ++it)
+        queues.pushBottom(std::move(*it));
+    pulled.clear();
+
+    return true;
 }
 
 bool Worker::steal(unique_ptr<Job> &job)
@@ -1,6 +1,7 @@
 #pragma once
 #include "LockFreeDeque.hh"
 #include "Job.hh"
+#include "JobFeed.hh"
 
 #include <atomic>
 #include <thread>
@@ -9,17 +10,48 @@
 class Worker
 {
 public:
-    Worker(LockFreeDeque<Job> &localQueue, vector<LockFreeDeque<Job> *> &all);
+    // `feed`, when given, refills the local queue once it runs dry
+    Worker(LockFreeDeque<Job> &localQueue, vector<LockFreeDeque<Job> *> &all, JobFeed *feed = nullptr);
     void start();
     void stop();
     void join();
 
+    // Worker whose thread is the calling thread, nullptr off the workers
+    static Worker *current();
+
+    // Push a job onto this worker's own queue (LIFO end)
+    void push(unique_ptr<Job> job);
+
+    /*
+    Run one job from the local queue, refilled from the feed, or stolen from another worker.
+    Returns false when there was nothing to run. Used by TaskGroup::sync to
+    keep the thread busy while it waits for its strands.
+    */
+    bool runOne();
+
+    // Run a job the way workers do: JobExecutor, or tasks() directly for spawned jobs
+    static void runJob(Job &job);
+
+    /*
+    Put off `flush` while the calling worker thread keeps running jobs of
+    `group` (Job::group): it is called before the thread runs any other job,
+    goes idle or exits, or defers for another group. One deferral per thread.
+    */
+    static void defer(const void *group, void (*flush)());
+
+    // Call the calling thread's deferred flush now, if any
+    static void flushDeferred();
+
 private:
     LockFreeDeque<Job> &queues;
     vector<LockFreeDeque<Job> *> &allQueues;
     thread threads;
     atomic<bool> running{true};
+    JobFeed *feed;
+    // Batch pulled from the feed, reused
+    vector<unique_ptr<Job>> pulled;
 
     void run();
+    bool refill();
     bool steal(unique_ptr<Job> &job);
 };
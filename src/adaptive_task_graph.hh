@@ -3,6 +3,46 @@
 #include "task_graph.hh"
 #include "WorkStealing.hh"
 
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+/*
+CPUs this process may actually use: the cgroup CPU quota when one is set
+(v2 cpu.max, then v1 cfs quota/period), capped by hardware_concurrency
+*/
+inline size_t available_cpus()
+{
+    size_t cpus = max(1u, thread::hardware_concurrency());
+    double quota = -1, period = 0;
+
+    ifstream v2("/sys/fs/cgroup/cpu.max");
+    string limit;
+    if (v2 >> limit >> period)
+    {
+        if (limit != "max")
+            quota = stod(limit);
+    }
+    else
+    {
+        ifstream v1Quota("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+        ifstream v1Period("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+        if (!(v1Quota >> quota) || !(v1Period >> period))
+            quota = -1;
+    }
+
+    if (quota > 0 && period > 0)
+        cpus = min(cpus, max<size_t>(1, static_cast<size_t>(ceil(quota / period))));
+
+    return cpus;
+}
+
+/*
+TaskGraph with a persistent pool, sized before every run:
+- target threads = min(widest level of the graph, available_cpus(), num_threads)
+- the pool is only rebuilt when the target grows past it, or falls below half
+  of it, so thread creation stays out of repeated runs of similar graphs
+*/
 struct AdaptiveTaskGraph : public TaskGraph
 {
     AdaptiveTaskGraph(size_t num_threads = thread::hardware_concurrency())
@@ -10,54 +50,24 @@ struct AdaptiveTaskGraph : public TaskGraph
 
     void execute()
     {
-        const size_t dynamic_threads = thread::hardware_concurrency();
-        WorkStealingThreadPool pool(dynamic_threads);
-
-        // Store the remaining dependencies for each task
-        unordered_map<Task<void> *, size_t> dependency_count;
-
-        // Backup: each task will have a list of tasks that depend on it
-        unordered_map<Task<void> *, vector<Task<void> *>> reverse_dependencies;
+        if (tasks.empty())
+            return;
 
-        queue<Task<void> *> ready_tasks;
+        GraphLayout layout = compile();
+        size_t target = min({max_level_width(layout), available_cpus(), max<size_t>(1, num_threads)});
+        target = max<size_t>(1, target);
 
-        // Initialize dependency_count and reverse_dependencies
-        for (auto &task_ptr : tasks)
+        if (!pool || target > pool->size() || target < pool->size() / 2)
         {
-            Task<void> *task = task_ptr.get();
-            size_t count = task->dependencies.size();
-            dependency_count[task] = count;
-
-            // If no dependencies, ready to run
-            if (count == 0)
-                ready_tasks.push(task);
-
-            // Create reverse mapping
-            for (Task<void> *dep : task->dependencies)
-            {
-                reverse_dependencies[dep].push_back(task);
-            }
+            pool.reset(); // Join the old workers before starting new ones
+            pool = make_unique<WorkStealingThreadPool>(target);
         }
 
-        // Start processing ready tasks
-        while (!ready_tasks.empty())
-        {
-            Task<void> *task = ready_tasks.front();
-            ready_tasks.pop();
-
-            // Move task into pool for execution
-            pool.enqueue(std::move(*task));
-
-            // Find tasks that depend on current task
-            for (Task<void> *dependent_task : reverse_dependencies[task])
-            {
-                if (--dependency_count[dependent_task] == 0)
-                {
-                    ready_tasks.push(dependent_task);
-                }
-            }
-        }
-
-        wait_all(); // Wait for all tasks to complete before the execute() function exits
+        // Completion-driven: each finished task releases its ready dependents
+        // onto the worker it finished on; returns once every task is done
+        TaskGraph::execute(*pool, std::move(layout));
     }
+
+    // Workers of the current pool, 0 before the first run
+    size_t threads() const { return pool ? pool->size() : 0; }
 };
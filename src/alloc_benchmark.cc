@@ -0,0 +1,130 @@
+#include "JobBuilder.hh"
+#include "JobDispatcher.hh"
+#include "Logger.hh"
+
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+
+namespace fs = filesystem;
+
+/*
+Heap allocations per job, std::function vs the move-only InplaceFunction
+- every operator new in the process is counted
+- "closure": storing the `[&, i]` lambda runBenchmark submits (four captures)
+- "job": a Job with that task plus onStart / onResult / onComplete callbacks
+  capturing the same state; the std::function row builds the same callables
+  into std::function objects, as Job held them before. Per-job callbacks cost
+  the JobDetails block; jobs stamped from a JobBuilder template share one
+- "submit": creating, dispatching and running the Job on a JobDispatcher,
+  including the executor's own bookkeeping (result strings, logging); the
+  Job itself comes from JobPool
+Usage: alloc_benchmark [jobs=10000] [threads=2]
+*/
+
+static atomic<size_t> allocations{0};
+
+void *operator new(size_t size)
+{
+    allocations.fetch_add(1, memory_order_relaxed);
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+template <typename F>
+static double allocationsPer(size_t count, F body)
+{
+    size_t before = allocations.load();
+    for (size_t i = 0; i < count; ++i)
+        body(static_cast<int>(i));
+    return static_cast<double>(allocations.load() - before) / count;
+}
+
+int main(int argc, char **argv)
+{
+    size_t jobs = argc > 1 ? stoul(argv[1]) : 10000;
+    int threads = argc > 2 ? stoi(argv[2]) : 2;
+
+    fs::create_directories("result");
+    Logger::instance().start("result/alloc_benchmark_log.txt", true);
+
+    ofstream csv("result/alloc_benchmark_result.csv");
+    csv << "stage,callable,allocations_per_job\n";
+
+    auto report = [&](const string &stage, const string &callable, double perJob)
+    {
+        csv << stage << "," << callable << "," << perJob << "\n";
+        cout << "[" << stage << "] " << callable << ": " << perJob << " allocations per job\n";
+    };
+
+    atomic<int> done{0};
+    int sleepMs = 0;
+    string category = "benchmark";
+
+    // Same captures as runBenchmark's job body
+    auto makeTask = [&](int i)
+    {
+        return [&, i]()
+        {
+            if (category.empty())
+                return;
+            if (sleepMs > 0 && i % 2 == 0)
+                this_thread::sleep_for(chrono::milliseconds(sleepMs));
+            done++;
+        };
+    };
+
+    report("closure", "std::function", allocationsPer(jobs, [&](int i)
+                                                      { function<void()> f = makeTask(i); }));
+    report("closure", "InplaceFunction", allocationsPer(jobs, [&](int i)
+                                                        { decltype(Job::tasks) f = makeTask(i); }));
+
+    report("job", "std::function", allocationsPer(jobs, [&](int i)
+                                                  {
+        function<void()> task = makeTask(i);
+        function<void()> onStart = [&, i]() { done += i & 0; };
+        function<void(const JobResult &)> onResult = [&, i](const JobResult &r) { done += (r.success ? 0 : 1) + (i & 0); };
+        function<void(bool, int, long long)> onComplete = [&, i](bool, int, long long) { done += (category.empty() ? 1 : 0) + (i & 0); }; }));
+    report("job", "InplaceFunction", allocationsPer(jobs, [&](int i)
+                                                    {
+        Job job(makeTask(i));
+        JobDetails &details = job.editDetails();
+        details.onStart = [&, i]() { done += i & 0; };
+        details.onResult = [&, i](const JobResult &r) { done += (r.success ? 0 : 1) + (i & 0); };
+        details.onComplete = [&, i](bool, int, long long) { done += (category.empty() ? 1 : 0) + (i & 0); }; }));
+
+    JobBuilder templateBuilder;
+    templateBuilder.onStart([&]() { done += 0; })
+        .onResult([&](const JobResult &r) { done += r.success ? 0 : 1; })
+        .onComplete([&](bool, int, long long) { done += category.empty() ? 1 : 0; });
+    report("job", "JobBuilder template", allocationsPer(jobs, [&](int i)
+                                                        { Job job = templateBuilder.build(makeTask(i)); }));
+
+    {
+        JobDispatcher dispatcher(threads);
+        done = 0;
+
+        size_t before = allocations.load();
+        for (size_t i = 0; i < jobs; ++i)
+            dispatcher.dispatch(static_cast<int>(i) % threads, make_unique<Job>(makeTask(static_cast<int>(i))));
+        while (done.load() < static_cast<int>(jobs))
+            this_thread::sleep_for(chrono::milliseconds(1));
+        size_t total = allocations.load() - before;
+        dispatcher.stop();
+
+        report("submit", "InplaceFunction", static_cast<double>(total) / jobs);
+    }
+
+    Logger::instance().stop();
+
+    cout << "\n Allocation benchmark complete.\n";
+    cout << "CSV:     result/alloc_benchmark_result.csv\n";
+}
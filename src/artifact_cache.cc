@@ -0,0 +1,137 @@
+#include "artifact_cache.hh"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+ArtifactCache::ArtifactCache(size_t memoryBytes, std::filesystem::path diskDir)
+    : capacity(memoryBytes), dir(std::move(diskDir))
+{
+    if (!dir.empty())
+        std::filesystem::create_directories(dir);
+}
+
+std::filesystem::path ArtifactCache::pathOf(uint64_t key) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return dir / name;
+}
+
+std::optional<std::string> ArtifactCache::get(uint64_t key)
+{
+    {
+        std::lock_guard lock(mtx);
+
+        auto it = index.find(key);
+        if (it != index.end())
+        {
+            lru.splice(lru.begin(), lru, it->second);
+            hitCount.fetch_add(1, std::memory_order_relaxed);
+            return it->second->second;
+        }
+    }
+
+    if (!dir.empty())
+    {
+        std::ifstream in(pathOf(key), std::ios::binary);
+        if (in)
+        {
+            std::string artifact((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+            std::lock_guard lock(mtx);
+            insert(key, artifact);
+            hitCount.fetch_add(1, std::memory_order_relaxed);
+            return artifact;
+        }
+    }
+
+    missCount.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+}
+
+void ArtifactCache::put(uint64_t key, std::string artifact)
+{
+    if (!dir.empty())
+    {
+        // Write then rename, so a crashed run never leaves a truncated artifact behind.
+        // Each writer gets its own temp file: two puts of one key must not interleave
+        static std::atomic<uint64_t> tempCounter{0};
+
+        std::filesystem::path target = pathOf(key);
+        std::filesystem::path temp = target;
+        temp += "." + std::to_string(tempCounter.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+
+        bool written = false;
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            out.write(artifact.data(), static_cast<std::streamsize>(artifact.size()));
+            out.flush();
+            written = out.good();
+            out.close();
+            written = written && !out.fail();
+        }
+
+        std::error_code ec;
+        if (written)
+            std::filesystem::rename(temp, target, ec);
+
+        // A failed write (ENOSPC, EIO) keeps the artifact in memory only
+        if (!written || ec)
+            std::filesystem::remove(temp, ec);
+    }
+
+    std::lock_guard lock(mtx);
+    insert(key, std::move(artifact));
+}
+
+bool ArtifactCache::contains(uint64_t key)
+{
+    {
+        std::lock_guard lock(mtx);
+        if (index.count(key))
+            return true;
+    }
+
+    return !dir.empty() && std::filesystem::exists(pathOf(key));
+}
+
+void ArtifactCache::clear()
+{
+    std::lock_guard lock(mtx);
+    lru.clear();
+    index.clear();
+    used = 0;
+}
+
+size_t ArtifactCache::memoryUsed() const
+{
+    std::lock_guard lock(mtx);
+    return used;
+}
+
+void ArtifactCache::insert(uint64_t key, std::string artifact)
+{
+    auto it = index.find(key);
+    if (it != index.end())
+    {
+        used -= it->second->second.size();
+        lru.erase(it->second);
+        index.erase(it);
+    }
+
+    if (artifact.size() > capacity)
+        return; // Would evict everything else; only the disk store keeps it
+
+    used += artifact.size();
+    lru.emplace_front(key, std::move(artifact));
+    index[key] = lru.begin();
+
+    while (used > capacity)
+    {
+        used -= lru.back().second.size();
+        index.erase(lru.back().first);
+        lru.pop_back();
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+/*
+Content-addressed store for graph node outputs.
+- in-memory LRU bounded by the total size of the stored artifacts
+- optional directory on disk: every artifact is also written there as
+  <key in hex>.bin, and memory misses fall back to it (and get promoted)
+Thread-safe.
+*/
+class ArtifactCache
+{
+public:
+    explicit ArtifactCache(size_t memoryBytes = 64 * 1024 * 1024, std::filesystem::path diskDir = {});
+
+    std::optional<std::string> get(uint64_t key);
+
+    void put(uint64_t key, std::string artifact);
+
+    bool contains(uint64_t key);
+
+    void clear(); // Memory only, the disk store is left alone
+
+    size_t hits() const { return hitCount.load(std::memory_order_relaxed); }
+    size_t misses() const { return missCount.load(std::memory_order_relaxed); }
+    size_t memoryUsed() const;
+
+private:
+    using Entry = std::pair<uint64_t, std::string>;
+
+    std::filesystem::path pathOf(uint64_t key) const;
+
+    // Expects mtx to be held
+    void insert(uint64_t key, std::string artifact);
+
+    size_t capacity;
+    std::filesystem::path dir;
+
+    mutable std::mutex mtx;
+    std::list<Entry> lru; // Most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+    size_t used = 0;
+
+    std::atomic<size_t> hitCount{0};
+    std::atomic<size_t> missCount{0};
+};
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+/*
+Coroutine producing a stream of values with `co_yield`, consumed with
+`co_await gen.next()`.
+- The producer may `co_await` anything between two yields (a channel, a timer,
+  `pool.schedule()`...), so no thread is parked while it waits.
+- Lazy: nothing runs until the first next().
+- Single consumer: next() must not be called again before the previous one resumed.
+
+    AsyncGenerator<int> numbers(int n)
+    {
+        for (int i = 0; i < n; ++i)
+            co_yield i;
+    }
+
+    while (auto value = co_await gen.next())
+        use(*value);
+*/
+template <typename T>
+class AsyncGenerator
+{
+public:
+    struct promise_type
+    {
+        std::optional<T> current;          // Last yielded value, moved out by next()
+        std::coroutine_handle<> consumer;  // Coroutine waiting in next()
+        std::exception_ptr exception;
+
+        AsyncGenerator get_return_object() noexcept
+        {
+            return AsyncGenerator{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        // Hand control back to the consumer after each value and at the end
+        struct ToConsumer
+        {
+            bool await_ready() noexcept { return false; }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept
+            {
+                return h.promise().consumer;
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        ToConsumer yield_value(T value)
+        {
+            current = std::move(value);
+            return {};
+        }
+
+        ToConsumer final_suspend() noexcept { return {}; }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() noexcept { exception = std::current_exception(); }
+    };
+
+    struct NextAwaiter
+    {
+        std::coroutine_handle<promise_type> handle;
+
+        bool await_ready() const noexcept { return !handle || handle.done(); }
+
+        // Resume the producer until it yields (or finishes), then come back here
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer) noexcept
+        {
+            handle.promise().consumer = consumer;
+            handle.promise().current.reset();
+            return handle;
+        }
+
+        // The next value, or nullopt once the producer has finished
+        std::optional<T> await_resume()
+        {
+            if (!handle)
+                return std::nullopt;
+
+            auto &promise = handle.promise();
+            if (handle.done())
+            {
+                if (promise.exception)
+                    std::rethrow_exception(std::exchange(promise.exception, nullptr));
+
+                return std::nullopt;
+            }
+
+            return std::move(promise.current);
+        }
+    };
+
+    AsyncGenerator() = default;
+
+    explicit AsyncGenerator(std::coroutine_handle<promise_type> h) : handle(h) {}
+
+    AsyncGenerator(const AsyncGenerator &) = delete;
+    AsyncGenerator &operator=(const AsyncGenerator &) = delete;
+
+    AsyncGenerator(AsyncGenerator &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+    AsyncGenerator &operator=(AsyncGenerator &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle)
+                handle.destroy();
+
+            handle = std::exchange(other.handle, nullptr);
+        }
+
+        return *this;
+    }
+
+    ~AsyncGenerator()
+    {
+        if (handle)
+            handle.destroy();
+    }
+
+    [[nodiscard]] NextAwaiter next() noexcept { return NextAwaiter{handle}; }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+};
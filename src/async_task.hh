@@ -3,12 +3,26 @@
 #include "task_graph.hh"
 #include "../third_party/asio-src/asio/include/asio.hpp"
 
-class AsyncIOContext
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/*
+io_context served by N threads.
+- as a NodeExecutor it starts graph nodes on one of its threads (asio::post,
+  never blocks the releasing thread)
+- sleep() / resume_on() are awaitables whose continuation runs on an io thread
+*/
+class AsyncIOContext : public NodeExecutor
 {
 public:
-    AsyncIOContext() : io_context(), work_guard(asio::make_work_guard(io_context))
+    explicit AsyncIOContext(size_t threads = std::max(1u, std::thread::hardware_concurrency()))
+        : io_context(static_cast<int>(threads)), work_guard(asio::make_work_guard(io_context))
     {
-        worker_thread = std::thread([this]() { io_context.run(); });
+        for (size_t i = 0; i < std::max<size_t>(1, threads); ++i)
+            worker_threads.emplace_back([this]()
+                                        { io_context.run(); });
     }
 
     asio::io_context &get_io_context()
@@ -16,79 +30,97 @@ public:
         return io_context;
     }
 
-    ~AsyncIOContext()
+    size_t size() const { return worker_threads.size(); }
+
+    void schedule(std::coroutine_handle<> handle) override
     {
-        io_context.stop();
-        if (worker_thread.joinable())
-            worker_thread.join();
+        asio::post(io_context, [handle]
+                   { handle.resume(); });
     }
 
-private:
-    asio::io_context io_context;
-    asio::executor_work_guard<asio::io_context::executor_type> work_guard;
-    std::thread worker_thread;
-};
-
-template <typename T>
-struct AsyncTask : public Task<T>
-{
-    static AsyncIOContext io_context; // Manage Async IO
-
-    void async_wait_for_io(std::chrono::milliseconds duration)
+    // `co_await io.resume_on()` continues the awaiting coroutine on an io thread
+    auto resume_on()
     {
-        auto timer = std::make_shared<asio::steady_timer>(io_context.get_io_context(), duration);
+        struct Awaiter
+        {
+            AsyncIOContext *io;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) { io->schedule(h); }
+            void await_resume() const noexcept {}
+        };
 
-        timer->async_wait([this, timer](const asio::error_code &)
-                          { this->handle.resume(); });
+        return Awaiter{this};
     }
-};
 
-struct AsyncTaskGraph : public TaskGraph
-{
-    void execute()
+    // `co_await io.sleep(duration)`: an asio timer, no thread is held while waiting
+    auto sleep(std::chrono::milliseconds duration)
     {
-        std::unordered_map<Task<void> *, size_t> dependency_count;
-        std::queue<Task<void> *> ready_tasks;
-
-        for (auto &task : tasks)
+        struct Awaiter
         {
-            size_t count = task->dependencies.size();
-            // dependency_count[&task] = count;
-            dependency_count[task.get()] = count;
-
-            if (count == 0)
-                // ready_tasks.push(&task);
-                ready_tasks.push(task.get());
-        }
+            std::shared_ptr<asio::steady_timer> timer;
+            asio::error_code error{};
 
-        while (!ready_tasks.empty())
-        {
-            Task<void> *task = ready_tasks.front();
-            ready_tasks.pop();
+            bool await_ready() const noexcept { return false; }
 
-            if (auto async_task = static_cast<AsyncTask<void> *>(task))
+            void await_suspend(std::coroutine_handle<> h)
             {
-                async_task->async_wait_for_io(std::chrono::milliseconds(500)); // Wait for simulated I/O
-            }
-            else
-            {
-                pool.enqueue([task]
-                             { task->execute(); });
+                timer->async_wait([this, h](const asio::error_code &ec)
+                                  {
+                    error = ec;
+                    h.resume(); });
             }
 
-            for (auto &next_task : tasks)
-            {
-                if (std::find(next_task->dependencies.begin(), next_task->dependencies.end(), *task) != next_task->dependencies.end())
-                {
-                    // if (--dependency_count[&next_task] == 0)
-                    // ready_tasks.push(&next_task);
-
-                    if (--dependency_count[next_task.get()] == 0)
-                        ready_tasks.push(next_task.get());
-                }
-            }
+            asio::error_code await_resume() const noexcept { return error; }
+        };
+
+        return Awaiter{std::make_shared<asio::steady_timer>(io_context, duration)};
+    }
+
+    ~AsyncIOContext()
+    {
+        work_guard.reset(); // Let run() return once pending handlers are done
+        for (std::thread &t : worker_threads)
+        {
+            if (t.joinable())
+                t.join();
         }
     }
+
+private:
+    asio::io_context io_context;
+    asio::executor_work_guard<asio::io_context::executor_type> work_guard;
+    std::vector<std::thread> worker_threads;
 };
 
+// Where an AsyncTaskGraph node runs
+enum class NodeKind
+{
+    Cpu, // Work-stealing pool
+    Io   // AsyncIOContext threads, for nodes that await asio operations
+};
+
+/*
+TaskGraph with typed nodes:
+- CPU nodes are started on the work-stealing pool
+- I/O nodes are started on the graph's io_context and resume there when the
+  asio operations they await complete
+Completions release successors on the thread that finished the node: CPU
+successors are pushed to the pool, I/O successors posted to the io_context,
+so neither side ever blocks waiting for the other.
+*/
+struct AsyncTaskGraph : public TaskGraph
+{
+    AsyncIOContext io;
+
+    AsyncTaskGraph(size_t cpu_threads = thread::hardware_concurrency(), size_t io_threads = 4)
+        : TaskGraph(cpu_threads), io(io_threads) {}
 
+    void addTask(std::shared_ptr<Task<void>> task, NodeKind kind = NodeKind::Cpu)
+    {
+        if (kind == NodeKind::Io)
+            TaskGraph::addTask(std::move(task), io);
+        else
+            TaskGraph::addTask(std::move(task));
+    }
+};
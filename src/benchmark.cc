@@ -1,16 +1,18 @@
 #include "benchmark.hh"
 
 #include "JobDispatcher.hh"
+#include "JobGroup.hh"
 #include "ProgressTracker.hh"
 
 #include <filesystem>
+#include <ranges>
 
 namespace fs = filesystem;
 
 void runBenchmark(int numThreads, int numJobs, int sleepPerJobMs, int &durationMs)
 {
   JobDispatcher dispatcher(numThreads);
-  atomic<int> done{0};
+  JobGroup group(dispatcher);
 
   // Set up tracker to log and monitor
   ProgressTracker tracker(numJobs);
@@ -19,11 +21,14 @@ void runBenchmark(int numThreads, int numJobs, int sleepPerJobMs, int &durationM
   tracker.setLogInterval(5);       // Log every 5s
   tracker.startHTTPServer(9090);   // Prometheus-style /metrics
 
-  // Create and dispatch jobs
-  for (int i = 0; i < numJobs; ++i)
+  // Interned once: completions index the tracker by slot
+  CategoryName category("benchmark");
+
+  // Create the job for index i
+  auto makeJob = [&](int i)
   {
-    auto jobPtr = make_unique<Job>([&, i]()
-                                   {
+    return make_unique<Job>([&, i]()
+                            {
       auto startJob = chrono::steady_clock::now();
       // simulate working time
       this_thread::sleep_for(chrono::milliseconds(sleepPerJobMs + (i % 5) * 5));
@@ -39,24 +44,25 @@ void runBenchmark(int numThreads, int numJobs, int sleepPerJobMs, int &durationM
       else if (measuredLatency > 100)
         level = LogLevel::Warn;
 
-      tracker.markJobDoneWithCategory("benchmark", measuredLatency, level);
-      done++; });
-
-    dispatcher.dispatch(i % numThreads, std::move(jobPtr));
-  }
+      tracker.markJobDoneWithCategory(category, measuredLatency, level); });
+  };
 
   auto start = chrono::steady_clock::now();
 
-  // Wait until all jobs are done
-  while (done.load() < numJobs)
-  {
-    this_thread::sleep_for(chrono::milliseconds(10));
-  }
+  // Jobs are created lazily: workers pull them in batches as their queues run dry
+  group.addFrom(views::iota(0, numJobs) | views::transform(makeJob));
+
+  // Wait until all jobs are done, or every job pulled before the source failed
+  group.wait();
 
   auto end = chrono::steady_clock::now();
   dispatcher.stop(); // Stop thread pool
   tracker.finish();
 
+  // The source threw (logged by the feed): report it rather than a partial run
+  if (exception_ptr error = dispatcher.jobFeed().error())
+    rethrow_exception(error);
+
   // Total execution time
   durationMs = chrono::duration_cast<chrono::milliseconds>(end - start).count();
 
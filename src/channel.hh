@@ -0,0 +1,270 @@
+#pragma once
+
+#include "WorkStealing.hh"
+
+#include <coroutine>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+/*
+Bounded multi-producer / multi-consumer channel between coroutines.
+- `co_await ch.send(v)` suspends while the buffer is full (backpressure) and
+  returns false if the channel was closed.
+- `co_await ch.receive()` suspends while the buffer is empty and returns
+  nullopt once the channel is closed and drained.
+- A capacity of 0 makes every send a rendezvous with a receiver.
+- Waiters are linked through their awaiters (which live in the suspended
+  coroutine frames), so suspending allocates nothing and parks no thread.
+- With a pool, woken coroutines are scheduled on it instead of being resumed
+  inline by whoever woke them.
+*/
+template <typename T>
+class Channel
+{
+public:
+    struct SendAwaiter
+    {
+        Channel *channel;
+        T value;
+        std::coroutine_handle<> handle{};
+        SendAwaiter *next = nullptr;
+        bool sent = false;
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> h)
+        {
+            handle = h;
+            return channel->suspendSend(this);
+        }
+
+        // false if the channel was closed before the value could be delivered
+        bool await_resume() const noexcept { return sent; }
+    };
+
+    struct ReceiveAwaiter
+    {
+        Channel *channel;
+        std::optional<T> value{};
+        std::coroutine_handle<> handle{};
+        ReceiveAwaiter *next = nullptr;
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> h)
+        {
+            handle = h;
+            return channel->suspendReceive(this);
+        }
+
+        std::optional<T> await_resume() { return std::move(value); }
+    };
+
+    explicit Channel(size_t capacity, WorkStealingThreadPool *pool = nullptr)
+        : capacity(capacity), pool(pool) {}
+
+    Channel(const Channel &) = delete;
+    Channel &operator=(const Channel &) = delete;
+
+    [[nodiscard]] SendAwaiter send(T value) { return SendAwaiter{this, std::move(value)}; }
+
+    [[nodiscard]] ReceiveAwaiter receive() { return ReceiveAwaiter{this}; }
+
+    // Non-suspending variants for callers outside a coroutine
+    bool trySend(T &value)
+    {
+        std::unique_lock lock(mtx);
+        if (closed)
+            return false;
+
+        if (ReceiveAwaiter *receiver = popWaiter(receiversHead, receiversTail))
+        {
+            receiver->value = std::move(value);
+            lock.unlock();
+            wake(receiver->handle);
+            return true;
+        }
+
+        if (buffer.size() >= capacity)
+            return false;
+
+        buffer.push_back(std::move(value));
+        return true;
+    }
+
+    std::optional<T> tryReceive()
+    {
+        std::unique_lock lock(mtx);
+        std::optional<T> value;
+        SendAwaiter *sender = takeLocked(value);
+        lock.unlock();
+
+        if (sender)
+            wake(sender->handle);
+
+        return value;
+    }
+
+    // Wake everybody: pending receivers get nullopt, pending senders get false
+    void close()
+    {
+        SendAwaiter *senders;
+        ReceiveAwaiter *receivers;
+
+        {
+            std::lock_guard lock(mtx);
+            if (closed)
+                return;
+
+            closed = true;
+            senders = std::exchange(sendersHead, nullptr);
+            receivers = std::exchange(receiversHead, nullptr);
+            sendersTail = nullptr;
+            receiversTail = nullptr;
+        }
+
+        while (receivers)
+        {
+            ReceiveAwaiter *next = receivers->next; // Read before the coroutine can resume
+            wake(receivers->handle);
+            receivers = next;
+        }
+
+        while (senders)
+        {
+            SendAwaiter *next = senders->next;
+            wake(senders->handle);
+            senders = next;
+        }
+    }
+
+    bool isClosed()
+    {
+        std::lock_guard lock(mtx);
+        return closed;
+    }
+
+private:
+    std::mutex mtx;
+    std::deque<T> buffer;
+    size_t capacity;
+    bool closed = false;
+    WorkStealingThreadPool *pool;
+
+    // FIFO lists of suspended coroutines
+    SendAwaiter *sendersHead = nullptr;
+    SendAwaiter *sendersTail = nullptr;
+    ReceiveAwaiter *receiversHead = nullptr;
+    ReceiveAwaiter *receiversTail = nullptr;
+
+    template <typename W>
+    static void pushWaiter(W *&head, W *&tail, W *waiter)
+    {
+        waiter->next = nullptr;
+        if (tail)
+            tail->next = waiter;
+        else
+            head = waiter;
+        tail = waiter;
+    }
+
+    template <typename W>
+    static W *popWaiter(W *&head, W *&tail)
+    {
+        W *waiter = head;
+        if (waiter)
+        {
+            head = waiter->next;
+            if (!head)
+                tail = nullptr;
+        }
+        return waiter;
+    }
+
+    void wake(std::coroutine_handle<> handle)
+    {
+        if (pool)
+            pool->schedule(handle);
+        else
+            handle.resume();
+    }
+
+    // Returns true if the sender must stay suspended
+    bool suspendSend(SendAwaiter *sender)
+    {
+        std::unique_lock lock(mtx);
+        if (closed)
+            return false;
+
+        if (ReceiveAwaiter *receiver = popWaiter(receiversHead, receiversTail))
+        {
+            receiver->value = std::move(sender->value);
+            sender->sent = true;
+            lock.unlock();
+            wake(receiver->handle);
+            return false;
+        }
+
+        if (buffer.size() < capacity)
+        {
+            buffer.push_back(std::move(sender->value));
+            sender->sent = true;
+            return false;
+        }
+
+        pushWaiter(sendersHead, sendersTail, sender);
+        return true;
+    }
+
+    /*
+    Take the oldest value (buffer first, then a blocked sender).
+    Returns the sender that was unblocked, to be woken once the lock is released.
+    */
+    SendAwaiter *takeLocked(std::optional<T> &value)
+    {
+        if (!buffer.empty())
+        {
+            value = std::move(buffer.front());
+            buffer.pop_front();
+
+            // A slot was freed: move the oldest blocked sender's value into it
+            if (SendAwaiter *sender = popWaiter(sendersHead, sendersTail))
+            {
+                buffer.push_back(std::move(sender->value));
+                sender->sent = true;
+                return sender;
+            }
+
+            return nullptr;
+        }
+
+        if (SendAwaiter *sender = popWaiter(sendersHead, sendersTail))
+        {
+            value = std::move(sender->value); // Rendezvous (capacity 0)
+            sender->sent = true;
+            return sender;
+        }
+
+        return nullptr;
+    }
+
+    // Returns true if the receiver must stay suspended
+    bool suspendReceive(ReceiveAwaiter *receiver)
+    {
+        std::unique_lock lock(mtx);
+        SendAwaiter *sender = takeLocked(receiver->value);
+
+        if (receiver->value || closed)
+        {
+            lock.unlock();
+            if (sender)
+                wake(sender->handle);
+            return false;
+        }
+
+        pushWaiter(receiversHead, receiversTail, receiver);
+        return true;
+    }
+};
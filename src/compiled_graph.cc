@@ -0,0 +1,322 @@
+#include "compiled_graph.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+/*
+Long-lived coroutine behind each node.
+- starts suspended; every resume runs the body once
+- then suspends in Completed, whose await_suspend releases the successors:
+  the driver is already suspended at that point, so it can be resumed again by
+  the next run() without racing the thread that finished it
+*/
+struct CompiledGraph::NodeDriver
+{
+    struct promise_type
+    {
+        NodeDriver get_return_object()
+        {
+            return {std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); } // Body exceptions are caught in drive()
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+struct CompiledGraph::Completed
+{
+    CompiledGraph *graph;
+    NodeId node;
+
+    bool await_ready() const noexcept { return false; }
+
+    // Nothing of the driver frame may be touched after finish(): run() can return and destroy the graph
+    void await_suspend(std::coroutine_handle<>) const noexcept { graph->finish(node); }
+
+    void await_resume() const noexcept {}
+};
+
+CompiledGraph::~CompiledGraph()
+{
+    for (std::coroutine_handle<> driver : drivers)
+        driver.destroy();
+}
+
+CompiledGraph::NodeId CompiledGraph::addBody(Body body)
+{
+    if (compiled)
+        throw std::logic_error("CompiledGraph::addNode: graph is already compiled");
+
+    if (bodies.size() >= UINT32_MAX)
+        throw std::length_error("CompiledGraph::addNode: too many nodes");
+
+    bodies.push_back(std::move(body));
+    costs.push_back(1.0); // Unknown cost: ranks fall back to path length in nodes
+    observed.push_back(0);
+    return static_cast<NodeId>(bodies.size() - 1);
+}
+
+void CompiledGraph::dependsOn(NodeId node, NodeId dependency)
+{
+    if (compiled)
+        throw std::logic_error("CompiledGraph::dependsOn: graph is already compiled");
+
+    if (node >= bodies.size() || dependency >= bodies.size())
+        throw std::out_of_range("CompiledGraph::dependsOn: unknown node");
+
+    edges.emplace_back(dependency, node);
+}
+
+void CompiledGraph::setCost(NodeId node, double costNs)
+{
+    if (node >= bodies.size())
+        throw std::out_of_range("CompiledGraph::setCost: unknown node");
+
+    costs[node] = costNs;
+}
+
+void CompiledGraph::compile()
+{
+    if (compiled)
+        return;
+
+    const size_t n = bodies.size();
+
+    // CSR successor lists: count, prefix sum, fill
+    succ_offsets.assign(n + 1, 0);
+    indegree.assign(n, 0);
+    for (auto [from, to] : edges)
+    {
+        ++succ_offsets[from + 1];
+        ++indegree[to];
+    }
+
+    for (size_t i = 0; i < n; ++i)
+        succ_offsets[i + 1] += succ_offsets[i];
+
+    successors.resize(edges.size());
+    std::vector<uint32_t> cursor(succ_offsets.begin(), succ_offsets.end() - 1);
+    for (auto [from, to] : edges)
+        successors[cursor[from]++] = to;
+
+    // Kahn pass: topological order, and a cycle leaves nodes unvisited
+    order.clear();
+    order.reserve(n);
+    sources.clear();
+    std::vector<uint32_t> pending(indegree);
+    for (NodeId i = 0; i < n; ++i)
+    {
+        if (pending[i] == 0)
+        {
+            order.push_back(i);
+            sources.push_back(i);
+        }
+    }
+
+    for (size_t head = 0; head < order.size(); ++head)
+    {
+        for (NodeId next : successorsOf(order[head]))
+        {
+            if (--pending[next] == 0)
+                order.push_back(next);
+        }
+    }
+
+    if (order.size() != n)
+        throw std::logic_error("CompiledGraph::compile: dependency cycle detected");
+
+    edges.clear();
+    edges.shrink_to_fit();
+
+    remaining.reset(new std::atomic<uint32_t>[n]);
+    ranks.assign(n, 0.0);
+    readyHeap.reserve(n);
+    drivers.reserve(n);
+    for (NodeId i = 0; i < n; ++i)
+        drivers.push_back(drive(this, i).handle);
+
+    compiled = true;
+}
+
+CompiledGraph::NodeDriver CompiledGraph::drive(CompiledGraph *graph, NodeId node)
+{
+    Body &body = graph->bodies[node];
+
+    while (true)
+    {
+        const bool measure = graph->scheduling == Scheduling::CriticalPath;
+        const auto start = measure ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+
+        try
+        {
+            if (body.coroutine)
+                co_await body.coroutine();
+            else
+                body.function();
+        }
+        catch (...)
+        {
+            graph->fail(std::current_exception());
+        }
+
+        if (measure)
+        {
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            graph->learnCost(node, elapsed.count());
+        }
+
+        co_await Completed{graph, node};
+    }
+}
+
+void CompiledGraph::run(WorkStealingThreadPool &workers)
+{
+    compile();
+
+    if (running.exchange(true, std::memory_order_acquire))
+        throw std::logic_error("CompiledGraph::run: graph is already running");
+
+    const size_t n = bodies.size();
+    if (n == 0)
+    {
+        running.store(false, std::memory_order_release);
+        return;
+    }
+
+    // Reset in place: no allocation and no analysis per run
+    pool = &workers;
+    for (size_t i = 0; i < n; ++i)
+        remaining[i].store(indegree[i], std::memory_order_relaxed);
+    unfinished.store(n, std::memory_order_relaxed);
+    failed.store(false, std::memory_order_relaxed);
+    firstError = nullptr;
+    finished = false;
+
+    if (scheduling == Scheduling::CriticalPath)
+    {
+        computeRanks();
+
+        std::lock_guard lock(readyMutex);
+        readyHeap.clear();
+        inFlight = 0;
+        slots = std::max<size_t>(1, workers.size());
+
+        for (NodeId source : sources)
+            ready(source);
+        dispatchReady();
+    }
+    else
+    {
+        for (NodeId source : sources)
+            workers.schedule(drivers[source]);
+    }
+
+    wait_helping(mtx, cv, [this]
+                 { return finished; });
+
+    std::exception_ptr error = std::exchange(firstError, nullptr);
+    running.store(false, std::memory_order_release);
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void CompiledGraph::finish(NodeId node)
+{
+    if (scheduling == Scheduling::CriticalPath)
+        return finishByRank(node);
+
+    for (NodeId next : successorsOf(node))
+    {
+        if (remaining[next].fetch_sub(1, std::memory_order_acq_rel) == 1)
+            pool->schedule(drivers[next]);
+    }
+
+    if (unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        std::lock_guard lock(mtx);
+        finished = true;
+        cv.notify_all();
+    }
+}
+
+void CompiledGraph::fail(std::exception_ptr error)
+{
+    if (!failed.exchange(true, std::memory_order_acq_rel))
+        firstError = std::move(error);
+}
+
+// Upward rank, in reverse topological order: rank(i) = cost(i) + max rank over successors
+void CompiledGraph::computeRanks()
+{
+    for (auto it = order.rbegin(); it != order.rend(); ++it)
+    {
+        double longest = 0.0;
+        for (NodeId next : successorsOf(*it))
+            longest = std::max(longest, ranks[next]);
+
+        ranks[*it] = costs[*it] + longest;
+    }
+}
+
+void CompiledGraph::ready(NodeId node)
+{
+    readyHeap.emplace_back(ranks[node], node);
+    std::push_heap(readyHeap.begin(), readyHeap.end());
+}
+
+// Fill the free worker slots with the highest-ranked ready nodes
+void CompiledGraph::dispatchReady()
+{
+    while (inFlight < slots && !readyHeap.empty())
+    {
+        std::pop_heap(readyHeap.begin(), readyHeap.end());
+        NodeId next = readyHeap.back().second;
+        readyHeap.pop_back();
+
+        ++inFlight;
+        pool->schedule(drivers[next]);
+    }
+}
+
+void CompiledGraph::finishByRank(NodeId node)
+{
+    {
+        std::lock_guard lock(readyMutex);
+
+        for (NodeId next : successorsOf(node))
+        {
+            if (remaining[next].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                ready(next);
+        }
+
+        --inFlight;
+        dispatchReady();
+    }
+
+    if (unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        std::lock_guard lock(mtx);
+        finished = true;
+        cv.notify_all();
+    }
+}
+
+// Only the node's own driver writes its cost, and runs never overlap
+void CompiledGraph::learnCost(NodeId node, double sampleNs)
+{
+    if (!observed[node])
+    {
+        costs[node] = sampleNs;
+        observed[node] = 1;
+        return;
+    }
+
+    costs[node] = 0.75 * costs[node] + 0.25 * sampleNs; // Smooth out noisy runs
+}
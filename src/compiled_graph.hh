@@ -0,0 +1,154 @@
+#pragma once
+
+#include "InplaceFunction.hh"
+#include "task.hh"
+#include "WorkStealing.hh"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+A DAG that is validated and analyzed once, then run any number of times.
+- nodes are bodies (`void()` or `Task<void>()`), not one-shot Task objects
+- compile() rejects cycles and builds the CSR successor lists, in-degrees and
+  topological order
+- every node owns a driver coroutine that lives as long as the graph, so a run
+  only resets the dependency counters and resumes the drivers of the sources
+- Scheduling::CriticalPath keeps at most one node per worker in flight and
+  hands free workers the ready node with the highest upward rank (its cost plus
+  the longest cost path to a sink), with costs learned from previous runs
+run() must not be called concurrently with itself, and the graph must outlive
+its runs.
+*/
+class CompiledGraph
+{
+public:
+    using NodeId = uint32_t;
+
+    enum class Scheduling
+    {
+        Fifo,        // Ready nodes go to the pool as soon as they are released
+        CriticalPath // Ready nodes wait in a max-rank queue for a free worker
+    };
+
+    CompiledGraph() = default;
+    ~CompiledGraph();
+
+    CompiledGraph(const CompiledGraph &) = delete;
+    CompiledGraph &operator=(const CompiledGraph &) = delete;
+
+    // Add a node; a body returning Task<void> is awaited, a new Task is created on every run
+    template <typename F>
+    NodeId addNode(F body)
+    {
+        if constexpr (std::is_same_v<std::invoke_result_t<F &>, Task<void>>)
+            return addBody(Body{{}, UniqueFunction<Task<void>()>(std::move(body))});
+        else
+            return addBody(Body{UniqueFunction<void()>(std::move(body)), {}});
+    }
+
+    // `node` runs after `dependency` has finished
+    void dependsOn(NodeId node, NodeId dependency);
+
+    // Validate and analyze the graph. Throws std::logic_error on a cycle; run() compiles on first use
+    void compile();
+
+    bool isCompiled() const { return compiled; }
+
+    // Takes effect on the next run()
+    void setScheduling(Scheduling policy) { scheduling = policy; }
+    Scheduling getScheduling() const { return scheduling; }
+
+    // Prior estimate of a node's duration (ns), refined by the durations measured in CriticalPath runs
+    void setCost(NodeId node, double costNs);
+    double cost(NodeId node) const { return costs[node]; }
+
+    // Upward rank computed for the last CriticalPath run
+    double rank(NodeId node) const { return ranks[node]; }
+
+    /*
+    Run every node once on `workers`, each after all of its dependencies.
+    Blocks until every node has finished and rethrows the first exception.
+    */
+    void run(WorkStealingThreadPool &workers);
+
+    size_t size() const { return bodies.size(); }
+
+    std::span<const NodeId> topologicalOrder() const { return order; }
+
+    std::span<const NodeId> successorsOf(NodeId node) const
+    {
+        return {successors.data() + succ_offsets[node], successors.data() + succ_offsets[node + 1]};
+    }
+
+private:
+    struct Body
+    {
+        UniqueFunction<void()> function;
+        UniqueFunction<Task<void>()> coroutine;
+    };
+
+    struct NodeDriver;
+    struct Completed;
+
+    NodeId addBody(Body body);
+
+    static NodeDriver drive(CompiledGraph *graph, NodeId node);
+
+    // Release the successors of a finished node; the last node wakes run()
+    void finish(NodeId node);
+
+    void fail(std::exception_ptr error);
+
+    // CriticalPath helpers: ready / dispatchReady expect readyMutex to be held
+    void computeRanks();
+    void ready(NodeId node);
+    void dispatchReady();
+    void finishByRank(NodeId node);
+    void learnCost(NodeId node, double sampleNs);
+
+    // Built by addNode / dependsOn
+    std::vector<Body> bodies;
+    std::vector<std::pair<NodeId, NodeId>> edges; // (dependency, node)
+    std::vector<double> costs;                    // Estimated duration per node (ns)
+    std::vector<uint8_t> observed;                // Whether costs[i] comes from a measured run
+
+    // Built once by compile()
+    bool compiled = false;
+    std::vector<uint32_t> succ_offsets;
+    std::vector<NodeId> successors;
+    std::vector<uint32_t> indegree;
+    std::vector<NodeId> order;
+    std::vector<NodeId> sources;
+    std::vector<std::coroutine_handle<>> drivers;
+    std::vector<double> ranks;
+
+    Scheduling scheduling = Scheduling::Fifo;
+
+    // Reset by every run()
+    std::unique_ptr<std::atomic<uint32_t>[]> remaining;
+    std::atomic<size_t> unfinished{0};
+    std::atomic<bool> running{false};
+    std::atomic<bool> failed{false};
+    std::exception_ptr firstError;
+    WorkStealingThreadPool *pool = nullptr;
+
+    // CriticalPath run state
+    std::mutex readyMutex;
+    std::vector<std::pair<double, NodeId>> readyHeap; // Max-heap on rank
+    size_t inFlight = 0;
+    size_t slots = 1;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool finished = false;
+};
@@ -2,11 +2,13 @@
 #include "Job.hh"
 #include "WorkStealing.hh"
 #include "JobFactory.hh"
+#include "JobGroup.hh"
 #include "adaptive_task_graph.hh"
 
 #include <filesystem>
 #include <future>
 #include <iostream>
+#include <random>
 
 namespace fs = filesystem;
 
@@ -68,36 +70,47 @@ void setupTracker(ProgressTracker &tracker)
 }
 
 /*
-run a series of jobs, monitor progress, handle retries, and log
+run one job with its retry loop, then record it in the tracker
 */
-Task<void> runMainTasks(ProgressTracker &tracker, Logger &log, int totalJobs, int maxRetries, int latencyThreshold)
+static Task<void> runMainJob(ProgressTracker &tracker, Logger &log, int id, int maxRetries, int latencyThreshold)
 {
-    for (int i = 0; i < totalJobs; ++i)
+    int retries = 0; // count current job retries
+
+    // result.first: latency,
+    // result.second: log level (Info, Warn, Error...)
+    pair<int, LogLevel> result;
+
+    while (retries < maxRetries)
     {
-        int retries = 0; // count current job retries
+        // Call coroutine simulateTask to execute job
+        result = co_await simulateTask(id, log);
 
-        // result.first: latency,
-        // result.second: log level (Info, Warn, Error...)
-        pair<int, LogLevel> result;
+        // If the job has a delay less than or equal to the allowed threshold → success, exit the retry loop
+        if (result.first <= latencyThreshold)
+            break;
 
-        while (retries < maxRetries)
-        {
-            // Call coroutine simulateTask to execute job
-            result = co_await simulateTask(i + 1, log);
+        log.dualSafeLog("Job " + to_string(id) + " latency too high (" + to_string(result.first) + " ms), retrying...");
+        ++retries;
+    }
 
-            // If the job has a delay less than or equal to the allowed threshold → success, exit the retry loop
-            if (result.first <= latencyThreshold)
-                break;
+    // Mark job complete
+    tracker.markJobDoneWithCategory("main", result.first, result.second);
+}
 
-            log.dualSafeLog("Job " + to_string(i + 1) + " latency too high (" + to_string(result.first) + " ms), retrying...");
-            ++retries;
-        }
+/*
+run a series of jobs, monitor progress, handle retries, and log
+- every job is started at once and awaited together (fan-out / fan-in)
+*/
+Task<void> runMainTasks(ProgressTracker &tracker, Logger &log, int totalJobs, int maxRetries, int latencyThreshold)
+{
+    vector<Task<void>> jobs;
+    jobs.reserve(totalJobs);
 
-        // Mark job complete
-        tracker.markJobDoneWithCategory("main", result.first, result.second);
-    }
+    for (int i = 0; i < totalJobs; ++i)
+        jobs.push_back(runMainJob(tracker, log, i + 1, maxRetries, latencyThreshold));
 
-    co_return;
+    // Resumes once the last job has finished
+    co_await when_all(std::move(jobs));
 }
 
 void runThreadPoolTasks(Logger &log)
@@ -114,7 +127,7 @@ void runThreadPoolTasks(Logger &log)
     for (int i = 1; i <= 10; ++i)
     {
         pool.enqueue(wrapAsTask([=, &log]()
-                                { simulateTask(i, log); }));
+                                { return simulateTask(i, log); }));
         /*
         ensures that 'i' is "frozen" at lambda creation — that is, each lambda will have its own copy of 'i'
         */
@@ -128,31 +141,27 @@ void runPostProcessingJobs()
 {
     auto start = chrono::steady_clock::now();
 
-    // Create a job to initialize the database (if it does not exist yet)
-    Job dbJob = createInitDatabaseJob();
-    // Create job to generate summary report
-    Job reportJob = createGenerateReportJob();
-    // Create a job to delete temporary files after processing is complete
-    Job cleanupJob = createCleanupTempFilesJob();
-
-    // Execute post-processing jobs in turn
-    // dbJob.execute();
-    // reportJob.execute();
-    // cleanupJob.execute();
-
-    future<void> f1 = async(launch::async, [&]
-                            { dbJob.execute(); });
-
-    future<void> f2 = async(launch::async, [&]
-                            { reportJob.execute(); });
-
-    future<void> f3 = async(launch::async, [&]
-                            { cleanupJob.execute(); });
-
-    // Wait for jobs to finish
-    f1.get();
-    f2.get();
-    f3.get();
+    // Run the post-processing jobs side by side, as one group
+    {
+        JobDispatcher dispatcher(3);
+        JobGroup group(dispatcher);
+
+        // Create a job to initialize the database (if it does not exist yet)
+        group.add([]
+                  { return createInitDatabaseJob().execute(); });
+        // Create job to generate summary report
+        group.add([]
+                  { return createGenerateReportJob().execute(); });
+        // Create a job to delete temporary files after processing is complete
+        group.add([]
+                  { return createCleanupTempFilesJob().execute(); });
+
+        // Wait for jobs to finish
+        JobGroupSummary summary = group.wait();
+        dispatcher.stop();
+
+        cout << "\n [POST] " << summary.succeeded << " succeeded, " << summary.failed << " failed\n";
+    }
 
     // -----------------------------------------------------------------------------------------
     AdaptiveTaskGraph graph;
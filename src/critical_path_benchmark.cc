@@ -0,0 +1,147 @@
+#include "compiled_graph.hh"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+namespace fs = filesystem;
+
+/*
+FIFO vs critical-path-first scheduling on random DAGs
+- every node busy-waits for its cost; most nodes are cheap, a random chain of
+  heavy nodes forms the critical path
+- each policy gets one warm-up run (CriticalPath learns the node costs from it),
+  then the makespan of `runs` runs is averaged
+- lower_bound_ms = max(critical path, total work / threads)
+Usage: critical_path_benchmark [nodes=2000] [threads] [graphs=5] [runs=5]
+*/
+
+struct RandomDag
+{
+    vector<chrono::microseconds> costs;
+    vector<pair<uint32_t, uint32_t>> edges; // (dependency, node)
+};
+
+static RandomDag makeRandomDag(size_t nodes, mt19937 &rng)
+{
+    RandomDag dag;
+    uniform_int_distribution<int> cheap(5, 50);
+    uniform_int_distribution<int> heavy(200, 600);
+    uniform_int_distribution<int> fanIn(1, 3);
+    bernoulli_distribution onChain(0.05);
+
+    uint32_t lastHeavy = 0;
+    for (uint32_t i = 0; i < nodes; ++i)
+    {
+        bool isHeavy = i == 0 || onChain(rng);
+        dag.costs.emplace_back(isHeavy ? heavy(rng) : cheap(rng));
+
+        if (i == 0)
+            continue;
+
+        // Heavy nodes extend the chain, every node also depends on a few recent nodes
+        if (isHeavy)
+        {
+            dag.edges.emplace_back(lastHeavy, i);
+            lastHeavy = i;
+        }
+
+        uniform_int_distribution<uint32_t> recent(i > 64 ? i - 64 : 0, i - 1);
+        for (int k = fanIn(rng); k > 0; --k)
+            dag.edges.emplace_back(recent(rng), i);
+    }
+
+    return dag;
+}
+
+static void spinFor(chrono::microseconds cost)
+{
+    auto until = chrono::steady_clock::now() + cost;
+    while (chrono::steady_clock::now() < until)
+    {
+    }
+}
+
+static double lowerBoundMs(const RandomDag &dag, size_t threads)
+{
+    vector<double> finish(dag.costs.size(), 0.0);
+    vector<vector<uint32_t>> preds(dag.costs.size());
+    for (auto [from, to] : dag.edges)
+        preds[to].push_back(from);
+
+    double total = 0.0, longest = 0.0;
+    for (size_t i = 0; i < dag.costs.size(); ++i) // Ids are already a topological order
+    {
+        double start = 0.0;
+        for (uint32_t p : preds[i])
+            start = max(start, finish[p]);
+
+        double cost = dag.costs[i].count() / 1000.0;
+        finish[i] = start + cost;
+        total += cost;
+        longest = max(longest, finish[i]);
+    }
+
+    return max(longest, total / threads);
+}
+
+static double makespanMs(CompiledGraph &graph, WorkStealingThreadPool &pool, size_t runs)
+{
+    graph.run(pool); // Warm-up (and cost learning for CriticalPath)
+
+    auto start = chrono::steady_clock::now();
+    for (size_t r = 0; r < runs; ++r)
+        graph.run(pool);
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+
+    return elapsed.count() / runs;
+}
+
+int main(int argc, char **argv)
+{
+    size_t nodes = argc > 1 ? stoul(argv[1]) : 2000;
+    size_t threads = argc > 2 ? stoul(argv[2]) : thread::hardware_concurrency();
+    size_t graphs = argc > 3 ? stoul(argv[3]) : 5;
+    size_t runs = argc > 4 ? max<size_t>(1, stoul(argv[4])) : 5;
+
+    fs::create_directories("result");
+    ofstream csv("result/critical_path_benchmark_result.csv");
+    csv << "graph,nodes,threads,fifo_ms,critical_path_ms,lower_bound_ms,speedup\n";
+
+    WorkStealingThreadPool pool(threads);
+    mt19937 rng(42);
+
+    for (size_t g = 0; g < graphs; ++g)
+    {
+        RandomDag dag = makeRandomDag(nodes, rng);
+
+        CompiledGraph graph;
+        for (auto cost : dag.costs)
+            graph.addNode([cost]
+                          { spinFor(cost); });
+        for (auto [from, to] : dag.edges)
+            graph.dependsOn(to, from);
+        graph.compile();
+
+        graph.setScheduling(CompiledGraph::Scheduling::Fifo);
+        double fifoMs = makespanMs(graph, pool, runs);
+
+        graph.setScheduling(CompiledGraph::Scheduling::CriticalPath);
+        double criticalMs = makespanMs(graph, pool, runs);
+
+        double boundMs = lowerBoundMs(dag, pool.size());
+        double speedup = fifoMs / criticalMs;
+
+        csv << g << "," << nodes << "," << pool.size() << "," << fifoMs << "," << criticalMs << ","
+            << boundMs << "," << speedup << "\n";
+        cout << "[graph " << g << "] nodes = " << nodes << ", threads = " << pool.size()
+             << ", fifo = " << fifoMs << " ms, critical path = " << criticalMs << " ms, lower bound = "
+             << boundMs << " ms, speedup = " << speedup << "x\n";
+    }
+
+    cout << "\n Critical path benchmark complete.\n";
+    cout << "CSV:     result/critical_path_benchmark_result.csv\n";
+}
@@ -0,0 +1,243 @@
+#include "compiled_graph.hh"
+#include "task_graph.hh"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace fs = filesystem;
+
+/*
+Task graph executor benchmark
+- wide: one root, N - 2 independent tasks, one sink joining all of them
+- deep: a single chain of N tasks (no parallelism, pure per-task overhead)
+Each shape runs once as a TaskGraph (built per run) and `runs` times as a
+CompiledGraph (built once, execute_ms is the average of the re-runs).
+- pipeline: 8 chains per worker of byte-transform stages over a 256 KB buffer each, every
+  4 chains joined by a merge node; run with and without locality partitioning
+  to compare the edges crossing workers
+Usage: graph_benchmark [nodes] [threads] [runs]
+*/
+
+static Task<void> countNode(atomic<size_t> &counter)
+{
+    counter.fetch_add(1, memory_order_relaxed);
+    co_return;
+}
+
+static void buildWide(TaskGraph &graph, size_t nodes, atomic<size_t> &counter)
+{
+    auto root = make_shared<Task<void>>(countNode(counter));
+    auto sink = make_shared<Task<void>>(countNode(counter));
+    graph.addTask(root);
+
+    for (size_t i = 2; i < nodes; ++i)
+    {
+        auto task = make_shared<Task<void>>(countNode(counter));
+        task->dependsOn(*root);
+        sink->dependsOn(*task);
+        graph.addTask(std::move(task));
+    }
+
+    graph.addTask(sink);
+}
+
+static void buildDeep(TaskGraph &graph, size_t nodes, atomic<size_t> &counter)
+{
+    shared_ptr<Task<void>> prev;
+
+    for (size_t i = 0; i < nodes; ++i)
+    {
+        auto task = make_shared<Task<void>>(countNode(counter));
+        if (prev)
+            task->dependsOn(*prev);
+
+        graph.addTask(task);
+        prev = std::move(task);
+    }
+}
+
+static void buildCompiled(CompiledGraph &graph, const string &shape, size_t nodes, atomic<size_t> &counter)
+{
+    auto body = [&counter]
+    { counter.fetch_add(1, memory_order_relaxed); };
+
+    if (shape == "wide")
+    {
+        auto root = graph.addNode(body);
+        vector<CompiledGraph::NodeId> middle;
+        for (size_t i = 2; i < nodes; ++i)
+        {
+            middle.push_back(graph.addNode(body));
+            graph.dependsOn(middle.back(), root);
+        }
+
+        auto sink = graph.addNode(body);
+        for (auto id : middle)
+            graph.dependsOn(sink, id);
+    }
+    else
+    {
+        auto prev = graph.addNode(body);
+        for (size_t i = 1; i < nodes; ++i)
+        {
+            auto id = graph.addNode(body);
+            graph.dependsOn(id, prev);
+            prev = id;
+        }
+    }
+
+    graph.compile();
+}
+
+static void report(const string &shape, size_t nodes, size_t threads, long long buildMs, long long execNs,
+                   size_t ran, ofstream &csv, size_t crossEdges = 0)
+{
+    double nsPerNode = static_cast<double>(execNs) / nodes;
+
+    csv << shape << "," << nodes << "," << threads << "," << buildMs << "," << execNs / 1000000 << "," << nsPerNode
+        << "," << crossEdges << "\n";
+    cout << "[" << shape << "] nodes = " << nodes << ", threads = " << threads
+         << ", build = " << buildMs << " ms, execute = " << execNs / 1000000 << " ms ("
+         << nsPerNode << " ns/node), ran = " << ran << ", cross-worker edges = " << crossEdges << "\n";
+}
+
+// Scalar on purpose: the target is built without -mavx2 (process_data_simd needs it)
+static Task<void> transformStage(span<uint8_t> data, atomic<size_t> &counter)
+{
+    for (uint8_t &byte : data)
+        byte += 1;
+
+    counter.fetch_add(1, memory_order_relaxed);
+    co_return;
+}
+
+static Task<void> mergeStage(vector<span<uint8_t>> inputs, atomic<size_t> &counter)
+{
+    size_t sum = 0;
+    for (auto data : inputs)
+    {
+        for (uint8_t byte : data)
+            sum += byte;
+    }
+
+    counter.fetch_add(sum == SIZE_MAX ? 0 : 1, memory_order_relaxed); // Keep the reads
+    co_return;
+}
+
+static void runPipeline(bool locality, WorkStealingThreadPool &pool, ofstream &csv)
+{
+    const size_t chains = pool.size() * 8;
+    const size_t stages = 16;
+    const size_t bufferSize = 256 * 1024;
+
+    atomic<size_t> counter{0};
+    vector<vector<uint8_t>> buffers(chains, vector<uint8_t>(bufferSize, 1));
+    TaskGraph graph(1);
+    graph.locality = locality;
+
+    auto buildStart = chrono::steady_clock::now();
+    vector<shared_ptr<Task<void>>> tails;
+    for (auto &buffer : buffers)
+    {
+        shared_ptr<Task<void>> prev;
+        for (size_t s = 0; s < stages; ++s)
+        {
+            auto task = make_shared<Task<void>>(transformStage(buffer, counter));
+            if (prev)
+                task->dependsOn(*prev);
+            graph.addTask(task);
+            prev = std::move(task);
+        }
+        tails.push_back(std::move(prev));
+    }
+
+    for (size_t c = 0; c < chains; c += 4)
+    {
+        vector<span<uint8_t>> inputs;
+        for (size_t k = c; k < min(chains, c + 4); ++k)
+            inputs.emplace_back(buffers[k]);
+
+        auto merge = make_shared<Task<void>>(mergeStage(std::move(inputs), counter));
+        for (size_t k = c; k < min(chains, c + 4); ++k)
+            merge->dependsOn(*tails[k]);
+        graph.addTask(std::move(merge));
+    }
+    auto buildEnd = chrono::steady_clock::now();
+
+    graph.execute(pool);
+    auto execEnd = chrono::steady_clock::now();
+
+    auto buildMs = chrono::duration_cast<chrono::milliseconds>(buildEnd - buildStart).count();
+    auto execNs = chrono::duration_cast<chrono::nanoseconds>(execEnd - buildEnd).count();
+
+    report(locality ? "pipeline_locality" : "pipeline", graph.tasks.size(), pool.size(), buildMs, execNs,
+           counter.load(), csv, graph.last_run.cross_worker_edges);
+}
+
+static void runCompiled(const string &shape, size_t nodes, size_t runs, WorkStealingThreadPool &pool, ofstream &csv)
+{
+    atomic<size_t> counter{0};
+    CompiledGraph graph;
+
+    auto buildStart = chrono::steady_clock::now();
+    buildCompiled(graph, shape, nodes, counter);
+    auto buildEnd = chrono::steady_clock::now();
+
+    for (size_t r = 0; r < runs; ++r)
+        graph.run(pool);
+    auto execEnd = chrono::steady_clock::now();
+
+    auto buildMs = chrono::duration_cast<chrono::milliseconds>(buildEnd - buildStart).count();
+    auto execNs = chrono::duration_cast<chrono::nanoseconds>(execEnd - buildEnd).count() / static_cast<long long>(runs);
+
+    report(shape + "_compiled", nodes, pool.size(), buildMs, execNs, counter.load(), csv);
+}
+
+static void runShape(const string &shape, size_t nodes, WorkStealingThreadPool &pool, ofstream &csv)
+{
+    atomic<size_t> counter{0};
+    TaskGraph graph(1);
+
+    auto buildStart = chrono::steady_clock::now();
+    if (shape == "wide")
+        buildWide(graph, nodes, counter);
+    else
+        buildDeep(graph, nodes, counter);
+    auto buildEnd = chrono::steady_clock::now();
+
+    graph.execute(pool);
+    auto execEnd = chrono::steady_clock::now();
+
+    auto buildMs = chrono::duration_cast<chrono::milliseconds>(buildEnd - buildStart).count();
+    auto execNs = chrono::duration_cast<chrono::nanoseconds>(execEnd - buildEnd).count();
+
+    report(shape, nodes, pool.size(), buildMs, execNs, counter.load(), csv, graph.last_run.cross_worker_edges);
+}
+
+int main(int argc, char **argv)
+{
+    size_t nodes = argc > 1 ? stoul(argv[1]) : 1000000;
+    size_t threads = argc > 2 ? stoul(argv[2]) : thread::hardware_concurrency();
+    size_t runs = argc > 3 ? max<size_t>(1, stoul(argv[3])) : 10;
+
+    fs::create_directories("result");
+    ofstream csv("result/graph_benchmark_result.csv");
+    csv << "shape,nodes,threads,build_ms,execute_ms,ns_per_node,cross_worker_edges\n";
+
+    WorkStealingThreadPool pool(threads);
+
+    for (const string shape : {"wide", "deep"})
+    {
+        runShape(shape, nodes, pool, csv);
+        runCompiled(shape, nodes, runs, pool, csv);
+    }
+
+    runPipeline(false, pool, csv);
+    runPipeline(true, pool, csv);
+
+    cout << "\n Graph benchmark complete.\n";
+    cout << "CSV:     result/graph_benchmark_result.csv\n";
+}
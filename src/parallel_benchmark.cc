@@ -0,0 +1,163 @@
+#include "parallel_algorithms.hh"
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+#if defined(HAVE_STD_EXECUTION_PAR) && __has_include(<execution>)
+#include <execution>
+#define BENCH_STD_PAR 1
+#else
+#define BENCH_STD_PAR 0
+#endif
+
+namespace fs = filesystem;
+
+/*
+parallel_* on the work-stealing pool vs the serial std algorithms, and
+std::execution::par when the build provides it (HAVE_STD_EXECUTION_PAR)
+- every algorithm runs on pools of 1, 2, 4, ... up to `threads` workers
+- each measurement is the best of `runs` runs; sort works on a fresh copy of
+  the input every run
+- std_par_ms uses the library's own thread count, so it is the same on every row
+Usage: parallel_benchmark [n=10000000] [threads] [runs=5]
+*/
+
+template <typename F>
+static double bestMs(size_t runs, F run)
+{
+    double best = 1e300;
+    for (size_t r = 0; r < runs; ++r)
+        best = min(best, run());
+    return best;
+}
+
+template <typename F>
+static double timeMs(F body)
+{
+    auto start = chrono::steady_clock::now();
+    body();
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+// A few flops per element, so for / transform are not purely memory bound
+static double work(double x)
+{
+    return sqrt(x) * 1.0001 + sin(x);
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? stoul(argv[1]) : 10'000'000;
+    size_t maxThreads = argc > 2 ? stoul(argv[2]) : thread::hardware_concurrency();
+    size_t runs = argc > 3 ? max<size_t>(1, stoul(argv[3])) : 5;
+    n = max<size_t>(1, n);
+    maxThreads = max<size_t>(1, maxThreads);
+
+    vector<size_t> poolSizes;
+    for (size_t threads = 1; threads < maxThreads; threads *= 2)
+        poolSizes.push_back(threads);
+    poolSizes.push_back(maxThreads);
+
+    vector<double> input(n);
+    mt19937_64 rng(42);
+    uniform_real_distribution<double> dist(0.0, 1e6);
+    for (double &v : input)
+        v = dist(rng);
+
+    vector<double> output(n);
+    double sink = 0.0; // Keeps results observable
+
+    fs::create_directories("result");
+    ofstream csv("result/parallel_benchmark_result.csv");
+    csv << "algorithm,n,threads,serial_ms,pool_ms,std_par_ms,speedup\n";
+
+    auto report = [&](const string &name, size_t threads, double serialMs, double poolMs, double parMs)
+    {
+        csv << name << "," << n << "," << threads << "," << serialMs << "," << poolMs << ",";
+        if (parMs >= 0)
+            csv << parMs;
+        csv << "," << serialMs / poolMs << "\n";
+
+        cout << "[" << name << "] threads = " << threads << ", serial = " << serialMs << " ms, pool = "
+             << poolMs << " ms";
+        if (parMs >= 0)
+            cout << ", std::par = " << parMs << " ms";
+        cout << ", speedup = " << serialMs / poolMs << "x\n";
+    };
+
+    // Serial baselines and std::par are independent of the pool size
+    double serialFor = bestMs(runs, [&]
+                              { return timeMs([&]
+                                              { for (size_t i = 0; i < n; ++i) output[i] = work(input[i]); }); });
+    double serialReduce = bestMs(runs, [&]
+                                 { return timeMs([&]
+                                                 { sink += accumulate(input.begin(), input.end(), 0.0); }); });
+    double serialScan = bestMs(runs, [&]
+                               { return timeMs([&]
+                                               { inclusive_scan(input.begin(), input.end(), output.begin()); }); });
+    double serialSort = bestMs(runs, [&]
+                               {
+        vector<double> data = input;
+        return timeMs([&]
+                      { sort(data.begin(), data.end()); }); });
+
+    double parTransform = -1, parReduce = -1, parScan = -1, parSort = -1;
+#if BENCH_STD_PAR
+    parTransform = bestMs(runs, [&]
+                          { return timeMs([&]
+                                          { transform(execution::par, input.begin(), input.end(), output.begin(), work); }); });
+    parReduce = bestMs(runs, [&]
+                       { return timeMs([&]
+                                       { sink += reduce(execution::par, input.begin(), input.end(), 0.0); }); });
+    parScan = bestMs(runs, [&]
+                     { return timeMs([&]
+                                     { inclusive_scan(execution::par, input.begin(), input.end(), output.begin()); }); });
+    parSort = bestMs(runs, [&]
+                     {
+        vector<double> data = input;
+        return timeMs([&]
+                      { sort(execution::par, data.begin(), data.end()); }); });
+#endif
+
+    for (size_t threads : poolSizes)
+    {
+        WorkStealingThreadPool pool(threads);
+
+        double poolFor = bestMs(runs, [&]
+                                { return timeMs([&]
+                                                { parallel_for(pool, 0, n, [&](size_t i)
+                                                               { output[i] = work(input[i]); }); }); });
+        report("for", threads, serialFor, poolFor, -1);
+
+        double poolTransform = bestMs(runs, [&]
+                                      { return timeMs([&]
+                                                      { parallel_transform(pool, input.begin(), input.end(), output.begin(), work); }); });
+        report("transform", threads, serialFor, poolTransform, parTransform);
+
+        double poolReduce = bestMs(runs, [&]
+                                   { return timeMs([&]
+                                                   { sink += parallel_reduce(pool, input.begin(), input.end(), 0.0); }); });
+        report("reduce", threads, serialReduce, poolReduce, parReduce);
+
+        double poolScan = bestMs(runs, [&]
+                                 { return timeMs([&]
+                                                 { parallel_inclusive_scan(pool, input.begin(), input.end(), output.begin()); }); });
+        report("inclusive_scan", threads, serialScan, poolScan, parScan);
+
+        double poolSort = bestMs(runs, [&]
+                                 {
+            vector<double> data = input;
+            return timeMs([&]
+                          { parallel_sort(pool, data.begin(), data.end()); }); });
+        report("sort", threads, serialSort, poolSort, parSort);
+    }
+
+    cout << "\n Parallel algorithms benchmark complete (checksum " << sink + output[n / 2] << ").\n";
+    cout << "CSV:     result/parallel_benchmark_result.csv\n";
+}
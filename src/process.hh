@@ -1,10 +1,15 @@
 
-#include <immintrin.h> // AVX/SSE support
+#include <cstdint>
 #include <span>
 
+#ifdef __AVX2__
+#include <immintrin.h> // AVX/SSE support
+#endif
+
 inline void process_data_simd(std::span<uint8_t> input)
 {
     size_t size = input.size();
+#ifdef __AVX2__
     size_t aligned_size = size - (size % 32); // Align for AVX (256-bit)
 
     for (size_t i = 0; i < aligned_size; i += 32)
@@ -13,6 +18,9 @@ inline void process_data_simd(std::span<uint8_t> input)
         data = _mm256_add_epi8(data, _mm256_set1_epi8(1)); // Perform SIMD operations
         _mm256_storeu_si256(reinterpret_cast<__m256i *>(&input[i]), data);
     }
+#else
+    size_t aligned_size = 0; // Built without -mavx2: scalar loop only
+#endif
 
     // Process the rest (if any)
     for (size_t i = aligned_size; i < size; ++i)
@@ -0,0 +1,149 @@
+#include "JobResult.hh"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+namespace fs = filesystem;
+
+/*
+Throughput of JobResult serialisation on one thread
+- "concat": the former toJSON, built with std::string + (no escaping)
+- "toJSON": one std::string per result, through JobResultWriter
+- "writer_json" / "writer_binary": a batch into a reused 64 KiB buffer, drained
+  whenever it fills up
+- allocations are counted through a global operator new
+Usage: serialize_benchmark [results=1000000] [runs=5]
+*/
+
+static atomic<size_t> allocations{0};
+
+void *operator new(size_t size)
+{
+    allocations.fetch_add(1, memory_order_relaxed);
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+static string concatJSON(const JobResult &r)
+{
+    string json = "{";
+    json += "\"jobId\": \"" + r.jobId + "\", ";
+    json += "\"category\": \"" + r.category.str() + "\", ";
+    json += "\"success\": " + string(r.success ? "true" : "false") + ", ";
+    json += "\"attempts\": " + to_string(r.attempts) + ", ";
+    json += "\"durationMs\": " + to_string(r.durationMs) + ", ";
+
+    if (r.errorMessage.has_value())
+        json += "\"error\": \"" + *r.errorMessage + "\", ";
+
+    json += "\"timestamp\": \"" + to_string(system_clock::to_time_t(r.endTime)) + "\"";
+
+    json += "}";
+    return json;
+}
+
+int main(int argc, char **argv)
+{
+    size_t count = argc > 1 ? stoul(argv[1]) : 1'000'000;
+    size_t runs = argc > 2 ? max<size_t>(1, stoul(argv[2])) : 5;
+
+    // A realistic mix: a few ids and categories, one result in ten failed
+    vector<JobResult> results(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        JobResult &r = results[i];
+        r.success = i % 10 != 0;
+        r.attempts = 1 + static_cast<int>(i % 3);
+        r.durationMs = static_cast<long long>(i % 500);
+        r.jobId = "job-" + to_string(i % 64);
+        r.category = CategoryName(i % 2 ? "benchmark" : "io");
+        r.startTime = system_clock::now();
+        r.endTime = r.startTime + milliseconds(r.durationMs);
+        if (!r.success)
+            r.errorMessage = "Timeout after 500ms";
+    }
+
+    fs::create_directories("result");
+    ofstream csv("result/serialize_benchmark_result.csv");
+    csv << "method,results,best_ms,results_per_sec,bytes,allocations_per_result\n";
+
+    vector<char> buffer(64 * 1024);
+    size_t sink = 0; // Keeps output observable
+
+    auto measure = [&](const string &method, auto body)
+    {
+        double best = 1e300;
+        size_t bytes = 0, allocated = 0;
+
+        for (size_t run = 0; run < runs; ++run)
+        {
+            size_t before = allocations.load();
+            auto start = chrono::steady_clock::now();
+            bytes = body();
+            chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+            allocated = allocations.load() - before;
+            best = min(best, elapsed.count());
+        }
+
+        double perSecond = count / (best / 1000.0);
+        double allocsPerResult = static_cast<double>(allocated) / count;
+        csv << method << "," << count << "," << best << "," << perSecond << "," << bytes << "," << allocsPerResult << "\n";
+        cout << "[" << method << "] " << best << " ms, " << perSecond / 1e6 << "M results/s, "
+             << bytes << " bytes, " << allocsPerResult << " allocations per result\n";
+    };
+
+    measure("concat", [&]
+            {
+        size_t bytes = 0;
+        for (const JobResult &r : results)
+            bytes += concatJSON(r).size();
+        return bytes; });
+
+    measure("toJSON", [&]
+            {
+        size_t bytes = 0;
+        for (const JobResult &r : results)
+            bytes += r.toJSON().size();
+        return bytes; });
+
+    auto batch = [&](bool binary)
+    {
+        JobResultWriter writer(buffer);
+        span<const JobResult> pending(results);
+        size_t bytes = 0;
+
+        while (!pending.empty())
+        {
+            size_t written = binary ? writer.appendBinary(pending) : writer.appendJSONLines(pending);
+            if (written == 0 && writer.size() == 0)
+                throw runtime_error("A result does not fit in the buffer");
+            pending = pending.subspan(written);
+
+            // Drain: a real caller would write view() to a file or socket here
+            bytes += writer.size();
+            sink += static_cast<unsigned char>(writer.view().back());
+            writer.clear();
+        }
+
+        return bytes;
+    };
+
+    measure("writer_json", [&]
+            { return batch(false); });
+    measure("writer_binary", [&]
+            { return batch(true); });
+
+    cout << "\n Serialization benchmark complete (checksum " << sink << ").\n";
+    cout << "CSV:     result/serialize_benchmark_result.csv\n";
+}
@@ -1,23 +1,179 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
 #include <coroutine>
+#include <cstdint>
+#include <exception>
 #include <mutex>
 #include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <utility>
+#include <variant>
 #include <vector>
-#include <condition_variable>
 
 #include "process.hh"
 
 template <typename T = void>
 struct Task;
 
-struct TaskPromiseBase
+/*
+Completion hook attached to a running Task.
+- A plain `co_await` stores the awaiting coroutine in `continuation`.
+- Combinators (when_all / when_any) set `callback` instead, so they can wait
+  on many children without spinning up a coroutine frame per child. It returns
+  the coroutine to resume (or nullptr) rather than resuming it: the finishing
+  Task transfers to it from final_suspend, so nothing nests on the stack.
+- Several hooks may wait on one Task (e.g. a graph node and another node's
+  body awaiting it): they are linked through `next`.
+*/
+struct TaskWaiter
 {
     std::coroutine_handle<> continuation;
+    std::coroutine_handle<> (*callback)(TaskWaiter *) noexcept = nullptr;
+    TaskWaiter *next = nullptr;
+};
+
+struct SpawnScope; // task_graph.hh
+
+/*
+Help-while-waiting hook.
+A thread pool installs `run_one` on each of its worker threads. A blocking wait
+on such a thread then keeps running queued work instead of parking the worker,
+so a worker waiting on work that sits in its own queue (nested waits, Task
+dependencies) cannot deadlock the pool or leave a core idle.
+*/
+struct WaitHelper
+{
+    bool (*run_one)(void *context) = nullptr; // Run one queued item; false if there was none
+    void *context = nullptr;
+};
+
+inline thread_local WaitHelper current_wait_helper;
+
+// Wait on `cv` until `done()` (checked under `mtx`), helping the current pool meanwhile
+template <typename Pred>
+void wait_helping(std::mutex &mtx, std::condition_variable &cv, Pred done)
+{
+    std::unique_lock lock(mtx);
+    const WaitHelper helper = current_wait_helper;
+
+    if (!helper.run_one)
+    {
+        cv.wait(lock, done);
+        return;
+    }
+
+    while (!done())
+    {
+        lock.unlock();
+        bool ran = helper.run_one(helper.context);
+        lock.lock();
+
+        // Nothing queued: the awaited work runs elsewhere. Sleep, but look for new work now and then
+        if (!ran && !done())
+            cv.wait_for(lock, std::chrono::microseconds(200));
+    }
+}
+
+struct TaskPromiseBase
+{
     std::mutex mtx;
     std::condition_variable cv;
     bool ready = false;
+
+    // Set by whoever starts the coroutine first (co_await, wait(), a pool...)
+    std::atomic<bool> started{false};
+
+    // nullptr: nobody waiting yet, TaskWaiter*: the last of the waiters linked
+    // through TaskWaiter::next, this: coroutine has finished
+    std::atomic<void *> waiter{nullptr};
+
+    // Waiter slot used by a plain `co_await task`
+    TaskWaiter awaiting;
+
+    // Join scope of the graph node this coroutine runs for (see TaskGraph::spawner)
+    SpawnScope *scope = nullptr;
+
+    bool is_ready() const noexcept { return waiter.load(std::memory_order_acquire) == this; }
+
+    // True for the one caller allowed to resume the coroutine for the first time
+    bool try_start() noexcept { return !started.exchange(true, std::memory_order_acq_rel); }
+
+    // Register w to be notified on completion, alongside any waiter already there;
+    // false only if the coroutine already finished
+    bool attach(TaskWaiter *w) noexcept
+    {
+        void *current = waiter.load(std::memory_order_acquire);
+        do
+        {
+            if (current == this)
+                return false;
+            assert(current != w && "a TaskWaiter is attached to a Task once");
+            w->next = static_cast<TaskWaiter *>(current);
+        } while (!waiter.compare_exchange_weak(current, w, std::memory_order_acq_rel, std::memory_order_acquire));
+
+        return true;
+    }
+
+    /*
+    Publishes completion, calls every waiter's callback and returns the
+    coroutine to resume next.
+    The frame may be destroyed as soon as `ready` is visible (or by a callback),
+    so nothing in it is touched after the lock is released: the continuation
+    waiter, `awaiting` in this promise, is unlinked beforehand.
+    */
+    std::coroutine_handle<> complete() noexcept
+    {
+        void *prev = waiter.exchange(this, std::memory_order_acq_rel);
+        TaskWaiter *callbacks = static_cast<TaskWaiter *>(prev);
+        std::coroutine_handle<> next = nullptr;
+
+        for (TaskWaiter **link = &callbacks; *link;)
+        {
+            TaskWaiter *w = *link;
+            if (w->callback)
+            {
+                link = &w->next;
+                continue;
+            }
+
+            next = w->continuation; // Only `awaiting` has none: a single co_await at a time
+            *link = w->next;
+        }
+
+        {
+            std::lock_guard lock(mtx);
+            ready = true;
+            cv.notify_all();
+        }
+
+        // A callback may free its own waiter
+        for (TaskWaiter *w = callbacks; w;)
+        {
+            TaskWaiter *after = w->next;
+            std::coroutine_handle<> resume = w->callback(w);
+            w = after;
+
+            if (!resume)
+                continue;
+
+            // One coroutine is transferred to; a further one (several combinators on this Task) runs here
+            if (next)
+                resume.resume();
+            else
+                next = resume;
+        }
+
+        return next ? next : std::noop_coroutine();
+    }
 };
 
 template <typename T>
@@ -28,8 +184,8 @@ struct TaskPromise : public TaskPromiseBase
 
     Task<T> get_return_object(); // Function returns Task object from promise
 
-    // Coroutine starts without suspending
-    std::suspend_never initial_suspend() { return {}; }
+    // Coroutine is lazy: it only starts when awaited, waited on or scheduled
+    std::suspend_always initial_suspend() { return {}; }
 
     // Coroutine will suspend at the end and continue to execute the next
     // coroutine (if any)
@@ -37,38 +193,20 @@ struct TaskPromise : public TaskPromiseBase
     {
         struct awaiter
         {
-            std::coroutine_handle<TaskPromise> handle;
-
             // Not ready, so coroutine will actually suspend
             bool await_ready() noexcept { return false; }
 
-            // Coroutine suspends here; continues previously called coroutine if any
-            void await_suspend(std::coroutine_handle<TaskPromise> h) noexcept
+            // Coroutine suspends here; transfers to the awaiting coroutine if any
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<TaskPromise> h) noexcept
             {
-                TaskPromise &promise = h.promise();
-
-                {
-                    std::unique_lock lock(promise.mtx);
-                    promise.ready = true; // Mark completed
-                }
-                promise.cv.notify_all();
-
-                if (promise.continuation)
-                    promise.continuation.resume(); // Continue to next coroutine
+                return h.promise().complete();
             }
 
-            // If there is an error in the coroutine, throw an exception
-            void await_resume() noexcept
-            {
-                if (handle.promise().exception)
-                    std::rethrow_exception(handle.promise().exception);
-            }
+            void await_resume() noexcept {}
         };
 
-        // return awaiter{};
-
         // Returns the awaiter that will be called in final_suspend
-        return awaiter{std::coroutine_handle<TaskPromise>::from_promise(*this)};
+        return awaiter{};
     }
 
     // Coroutine throws error without handling -> saves exception
@@ -94,36 +232,21 @@ struct TaskPromise<void> : public TaskPromiseBase
 
     Task<void> get_return_object();
 
-    std::suspend_never initial_suspend() { return {}; }
+    std::suspend_always initial_suspend() { return {}; }
 
     auto final_suspend() noexcept
     {
         // Custom awaiter handles coroutine end logic
         struct awaiter
         {
-            TaskPromise *promises;
-
             bool await_ready() noexcept { return false; }
 
-            void await_suspend(std::coroutine_handle<TaskPromise> h) noexcept
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<TaskPromise> h) noexcept
             {
-                TaskPromise &promise = h.promise();
-                {
-                    std::unique_lock lock(promise.mtx);
-                    promise.ready = true;
-                }
-
-                promise.cv.notify_all();
-
-                if (promise.continuation)
-                    promise.continuation.resume();
+                return h.promise().complete();
             }
 
-            void await_resume() noexcept
-            {
-                if (promises->exception)
-                    std::rethrow_exception(promises->exception);
-            }
+            void await_resume() noexcept {}
         };
 
         return awaiter{};
@@ -143,6 +266,9 @@ struct Task<void>
     std::coroutine_handle<promise_type> handle;
     std::vector<Task<void> *> dependencies; // List of dependent coroutines
 
+    // Dense id assigned by TaskGraph::addTask (position in the graph's task list)
+    size_t graph_index = SIZE_MAX;
+
     // no coroutine needed right now
     Task() : handle(nullptr) {}
 
@@ -172,17 +298,32 @@ struct Task<void>
             handle.destroy();
     }
 
-    // Always suspend to keep coroutine running
-    bool await_ready() { return false; }
+    // Only skip suspension if the coroutine has already finished
+    bool await_ready() const noexcept { return !handle || handle.promise().is_ready(); }
 
     bool operator==(const Task<void> &other) const
     {
         return handle == other.handle; // Compare based on coroutine handle
     }
 
-    void await_suspend(std::coroutine_handle<> h)
+    // Register the caller, then start the coroutine if nobody else has
+    template <typename P>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept
     {
-        handle.promise().continuation = h;
+        auto &promise = handle.promise();
+        promise.awaiting.continuation = h;
+
+        // Work spawned by an awaited helper joins the caller's graph node
+        if constexpr (std::is_base_of_v<TaskPromiseBase, P>)
+        {
+            if (!promise.scope)
+                promise.scope = h.promise().scope;
+        }
+
+        if (!promise.attach(&promise.awaiting))
+            return h; // Finished in the meantime, continue the caller directly
+
+        return start();
     }
 
     void await_resume()
@@ -191,13 +332,32 @@ struct Task<void>
             std::rethrow_exception(handle.promise().exception);
     }
 
+    // Returns the handle to resume if this call started the coroutine, otherwise a no-op
+    std::coroutine_handle<> start() noexcept
+    {
+        if (handle.promise().try_start())
+            return handle;
+
+        return std::noop_coroutine();
+    }
+
+    // On a pool worker, queued work is run while waiting (see wait_helping)
     void wait()
     {
-        handle.resume();
-        std::unique_lock lock(handle.promise().mtx);
+        start().resume();
 
-        handle.promise().cv.wait(lock, [&]
-                                 { return handle.promise().ready; });
+        auto &promise = handle.promise();
+        wait_helping(promise.mtx, promise.cv, [&]
+                     { return promise.ready; });
+    }
+
+    // Run coroutine, wait for it and rethrow its exception if any
+    void get()
+    {
+        wait();
+
+        if (handle.promise().exception)
+            std::rethrow_exception(handle.promise().exception);
     }
 
     void add_dependency(Task<void> &dep)
@@ -214,7 +374,7 @@ struct Task<void>
                 d->wait(); // Wait for dependent coroutine to complete
         }
 
-        handle.resume();
+        start().resume();
     }
 
     // ✅  Add dependency via pointer
@@ -263,13 +423,26 @@ struct Task
             handle.destroy();
     }
 
-    // Always suspend to keep coroutine running
-    bool await_ready() { return false; }
+    // Only skip suspension if the coroutine has already finished
+    bool await_ready() const noexcept { return !handle || handle.promise().is_ready(); }
 
-    // When co_await Task, save the calling coroutine (continuation)
-    void await_suspend(std::coroutine_handle<> h)
+    // When co_await Task, save the calling coroutine (continuation) and start this one
+    template <typename P>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept
     {
-        handle.promise().continuation = h;
+        auto &promise = handle.promise();
+        promise.awaiting.continuation = h;
+
+        if constexpr (std::is_base_of_v<TaskPromiseBase, P>)
+        {
+            if (!promise.scope)
+                promise.scope = h.promise().scope;
+        }
+
+        if (!promise.attach(&promise.awaiting))
+            return h; // Finished in the meantime, continue the caller directly
+
+        return start();
     }
 
     // When coroutine completes, return result
@@ -285,15 +458,25 @@ struct Task
         return std::move(promise.value).value();
     }
 
-    // Run coroutine and wait until it completes (synchronous)
+    // Returns the handle to resume if this call started the coroutine, otherwise a no-op
+    std::coroutine_handle<> start() noexcept
+    {
+        if (handle.promise().try_start())
+            return handle;
+
+        return std::noop_coroutine();
+    }
+
+    // Run coroutine and wait until it completes (synchronous).
+    // On a pool worker, queued work is run while waiting (see wait_helping)
     void wait()
     {
-        handle.resume(); // Start coroutine execution
-        std::unique_lock lock(handle.promise().mtx);
+        start().resume(); // Start coroutine execution (if not already running)
 
         // Wait until the coroutine marked as completed
-        handle.promise().cv.wait(lock, [&]
-                                 { return handle.promise().ready; });
+        auto &promise = handle.promise();
+        wait_helping(promise.mtx, promise.cv, [&]
+                     { return promise.ready; });
     }
 
     // Run coroutine and return result after waiting
@@ -316,7 +499,7 @@ struct Task
                 dep->wait();
         }
 
-        handle.resume();
+        start().resume();
     }
 
     // ✅ NEW: Add dependency
@@ -326,7 +509,353 @@ struct Task
     }
 };
 
+// Anything that can be used with `co_await` directly
+template <typename A>
+concept Awaitable = requires(A a, std::coroutine_handle<> h) {
+    a.await_ready();
+    a.await_suspend(h);
+    a.await_resume();
+};
+
+// Result type of a child inside when_all: void children produce std::monostate
+template <typename T>
+using when_all_value_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+/*
+Countdown latch shared by the children of a when_all.
+It starts at (children + 1): the extra count is released by the awaiter itself
+once every child has been started, so a child that finishes synchronously can
+never resume the parent before it has actually suspended.
+*/
+struct WhenAllLatch
+{
+    std::atomic<size_t> count;
+    std::coroutine_handle<> continuation;
+
+    explicit WhenAllLatch(size_t children) : count(children + 1) {}
+
+    // True for the last arrival
+    bool arrive() noexcept { return count.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+};
+
+// Per-child waiter, stored inline in the awaiter (no allocation per child)
+struct WhenAllWaiter : TaskWaiter
+{
+    WhenAllLatch *latch = nullptr;
+
+    // The last arrival hands the parent back to the finishing child's final_suspend
+    static std::coroutine_handle<> on_complete(TaskWaiter *w) noexcept
+    {
+        auto *self = static_cast<WhenAllWaiter *>(w);
+        if (self->latch->arrive())
+            return self->latch->continuation;
+
+        return nullptr;
+    }
+};
+
+// Combinators own and start their children: an empty (default or moved-from) Task has no result to give
+template <typename T>
+void require_task(const Task<T> &task, const char *combinator)
+{
+    if (!task.handle)
+        throw std::invalid_argument(std::string(combinator) + " got an empty Task");
+}
+
+// Hook the waiter onto the child and start it on the current thread
+template <typename T>
+void when_all_start(Task<T> &task, WhenAllWaiter &waiter, WhenAllLatch &latch)
+{
+    waiter.latch = &latch;
+    waiter.callback = &WhenAllWaiter::on_complete;
+
+    if (!task.handle.promise().attach(&waiter))
+    {
+        latch.arrive(); // Already finished; never the last arrival thanks to the extra count
+        return;
+    }
+
+    task.start().resume();
+}
+
+// Move the result out of a finished child, rethrowing its exception if any
+template <typename T>
+when_all_value_t<T> when_all_take(Task<T> &task)
+{
+    auto &promise = task.handle.promise();
+    if (promise.exception)
+        std::rethrow_exception(promise.exception);
+
+    if constexpr (std::is_void_v<T>)
+        return {};
+    else
+        return std::move(*promise.value);
+}
+
+template <typename... Ts>
+struct WhenAllAwaiter
+{
+    std::tuple<Task<Ts>...> tasks;
+    std::array<WhenAllWaiter, sizeof...(Ts)> waiters; // Empty for when_all()
+    WhenAllLatch latch{sizeof...(Ts)};
+
+    explicit WhenAllAwaiter(Task<Ts> &&...t) : tasks(std::move(t)...) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    // Start every child; only suspend if at least one is still running
+    bool await_suspend(std::coroutine_handle<> h) noexcept
+    {
+        latch.continuation = h;
+        start_all(std::index_sequence_for<Ts...>{});
+        return !latch.arrive();
+    }
+
+    std::tuple<when_all_value_t<Ts>...> await_resume()
+    {
+        return take_all(std::index_sequence_for<Ts...>{});
+    }
+
+private:
+    template <size_t... I>
+    void start_all(std::index_sequence<I...>)
+    {
+        (when_all_start(std::get<I>(tasks), waiters[I], latch), ...);
+    }
+
+    template <size_t... I>
+    std::tuple<when_all_value_t<Ts>...> take_all(std::index_sequence<I...>)
+    {
+        return {when_all_take(std::get<I>(tasks))...};
+    }
+};
+
+template <typename T>
+struct WhenAllVectorAwaiter
+{
+    std::vector<Task<T>> tasks;
+    std::vector<WhenAllWaiter> waiters; // One allocation for the whole batch
+    WhenAllLatch latch;
+
+    explicit WhenAllVectorAwaiter(std::vector<Task<T>> &&t)
+        : tasks(std::move(t)), waiters(tasks.size()), latch(tasks.size()) {}
+
+    bool await_ready() const noexcept { return tasks.empty(); }
+
+    bool await_suspend(std::coroutine_handle<> h) noexcept
+    {
+        latch.continuation = h;
+
+        for (size_t i = 0; i < tasks.size(); ++i)
+            when_all_start(tasks[i], waiters[i], latch);
+
+        return !latch.arrive();
+    }
+
+    auto await_resume()
+    {
+        if constexpr (std::is_void_v<T>)
+        {
+            for (auto &task : tasks)
+                when_all_take(task);
+        }
+        else
+        {
+            std::vector<T> results;
+            results.reserve(tasks.size());
+
+            for (auto &task : tasks)
+                results.push_back(when_all_take(task));
+
+            return results;
+        }
+    }
+};
+
+/*
+Run several tasks concurrently and resume once all of them have finished.
+- Children start on the awaiting thread and run until their first suspension
+  point (e.g. `co_await pool.schedule()` or sleepAsync), so independent stages
+  overlap instead of running one after another.
+- Returns a tuple of results (std::monostate for Task<void>).
+- If any child throws, the first exception (in argument order) is rethrown
+  after every child has finished.
+- An empty Task throws std::invalid_argument before anything starts.
+*/
+template <typename... Ts>
+[[nodiscard]] WhenAllAwaiter<Ts...> when_all(Task<Ts>... tasks)
+{
+    (require_task(tasks, "when_all()"), ...);
+    return WhenAllAwaiter<Ts...>(std::move(tasks)...);
+}
+
+// Same as above for a dynamic number of tasks; returns vector<T> (or void)
+template <typename T>
+[[nodiscard]] WhenAllVectorAwaiter<T> when_all(std::vector<Task<T>> tasks)
+{
+    for (const auto &task : tasks)
+        require_task(task, "when_all()");
+
+    return WhenAllVectorAwaiter<T>(std::move(tasks));
+}
 
+template <typename T>
+struct WhenAnyResult
+{
+    size_t index; // Position of the first task to finish
+    T value;
+};
+
+/*
+Shared state of a when_any. The losers keep running after the winner resumes
+the caller, so the state (and the child frames in it) is released by whoever
+drops the last reference: one allocation for the whole batch.
+*/
+template <typename T>
+struct WhenAnyState
+{
+    struct Waiter : TaskWaiter
+    {
+        WhenAnyState *state = nullptr;
+        size_t index = 0;
+    };
+
+    std::vector<Task<T>> tasks;
+    std::vector<Waiter> waiters;
+    std::atomic<size_t> refs;          // Running children + the awaiter
+    std::atomic<bool> decided{false};  // Set by the first child to finish
+    std::atomic<int> wake{2};          // Winner + awaiter: the second one resumes the caller
+    size_t winner = 0;
+    std::coroutine_handle<> continuation;
+
+    explicit WhenAnyState(std::vector<Task<T>> &&t)
+        : tasks(std::move(t)), waiters(tasks.size()), refs(tasks.size() + 1) {}
+
+    void release() noexcept
+    {
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete this;
+    }
+
+    // Returns true if the caller should be resumed now
+    bool finish(size_t index) noexcept
+    {
+        if (decided.exchange(true, std::memory_order_acq_rel))
+            return false;
+
+        winner = index;
+        return wake.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    // The awaiter holds a reference until the caller resumes, so the state outlives the release below
+    static std::coroutine_handle<> on_complete(TaskWaiter *w) noexcept
+    {
+        auto *self = static_cast<Waiter *>(w);
+        WhenAnyState *state = self->state;
+        std::coroutine_handle<> resume = state->finish(self->index) ? state->continuation : nullptr;
+
+        state->release();
+        return resume;
+    }
+};
+
+template <typename T>
+struct WhenAnyAwaiter
+{
+    WhenAnyState<T> *state;
+
+    explicit WhenAnyAwaiter(std::vector<Task<T>> &&tasks) : state(new WhenAnyState<T>(std::move(tasks))) {}
+
+    WhenAnyAwaiter(const WhenAnyAwaiter &) = delete;
+    WhenAnyAwaiter &operator=(const WhenAnyAwaiter &) = delete;
+
+    ~WhenAnyAwaiter()
+    {
+        if (state)
+            state->release();
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> h) noexcept
+    {
+        state->continuation = h;
+
+        for (size_t i = 0; i < state->tasks.size(); ++i)
+        {
+            auto &task = state->tasks[i];
+            auto &waiter = state->waiters[i];
+            waiter.state = state;
+            waiter.index = i;
+            waiter.callback = &WhenAnyState<T>::on_complete;
+
+            // Once a winner is known there is no point in starting the rest
+            if (state->decided.load(std::memory_order_acquire))
+            {
+                state->release();
+                continue;
+            }
+
+            if (!task.handle.promise().attach(&waiter))
+            {
+                // Already finished: it can win, but only the awaiter's own arrival below resumes
+                state->finish(i);
+                state->release();
+                continue;
+            }
+
+            task.start().resume();
+        }
+
+        return state->wake.fetch_sub(1, std::memory_order_acq_rel) != 1;
+    }
+
+    auto await_resume()
+    {
+        size_t index = state->winner;
+        auto &promise = state->tasks[index].handle.promise();
+
+        if (promise.exception)
+            std::rethrow_exception(promise.exception);
+
+        if constexpr (std::is_void_v<T>)
+            return index;
+        else
+            return WhenAnyResult<T>{index, std::move(*promise.value)};
+    }
+};
+
+/*
+Run tasks concurrently and resume as soon as the first one finishes.
+- Returns the index of the winner (plus its value for non-void tasks).
+- The remaining tasks are not cancelled; they run to completion in the
+  background and are destroyed by the last one to finish.
+- No task, or an empty Task, throws std::invalid_argument.
+*/
+template <typename T>
+[[nodiscard]] WhenAnyAwaiter<T> when_any(std::vector<Task<T>> tasks)
+{
+    if (tasks.empty())
+        throw std::invalid_argument("when_any() needs at least one task");
+
+    for (const auto &task : tasks)
+        require_task(task, "when_any()");
+
+    return WhenAnyAwaiter<T>(std::move(tasks));
+}
+
+template <typename T, typename... Rest>
+[[nodiscard]] WhenAnyAwaiter<T> when_any(Task<T> first, Task<Rest>... rest)
+{
+    static_assert((std::is_same_v<T, Rest> && ...), "when_any() expects tasks of the same type");
+
+    std::vector<Task<T>> tasks;
+    tasks.reserve(1 + sizeof...(Rest));
+    tasks.push_back(std::move(first));
+    (tasks.push_back(std::move(rest)), ...);
+
+    return when_any(std::move(tasks));
+}
 
 inline Task<void> process_simd_data(Task<void> dep_task, std::span<uint8_t> data)
 {
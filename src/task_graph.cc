@@ -2,110 +2,925 @@
 
 #include "task_graph.hh"
 
-Thread_Pool::Thread_Pool(size_t num_threads)
+#include <algorithm>
+#include <future>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+/*
+Bookkeeping for one run of a compiled layout: a TaskGraph::execute() call, or
+a subgraph spawned from a running node.
+- remaining[i]: dependencies of node i that have not finished yet
+- each node is a TaskWaiter (fires when its body finishes) and a SpawnScope
+  (fires once the body and everything it spawned have finished)
+The join of a node's last dependency releases it, on the thread that joined it.
+*/
+struct GraphRun
+{
+    struct Node final : TaskWaiter, SpawnScope
+    {
+        GraphRun *run = nullptr;
+        uint32_t index = 0;
+        size_t worker = SIZE_MAX; // Worker the body finished on
+
+        void joined() noexcept override { run->finish(index); }
+
+        void fail(std::exception_ptr error) noexcept override { run->fail(std::move(error)); }
+    };
+
+    GraphLayout layout;
+    WorkStealingThreadPool &pool;
+    std::unique_ptr<Node[]> nodes;
+    std::unique_ptr<std::atomic<uint32_t>[]> remaining;
+    std::atomic<size_t> unfinished; // Nodes not joined yet, + 1 while start() is running
+
+    // Worker owning each node's cluster (see partition_for_locality); empty: schedule locally
+    std::vector<uint32_t> home;
+
+    // Nodes started somewhere else than the pool, by id (may be shorter than the graph)
+    const std::vector<NodeExecutor *> *executors = nullptr;
+
+    // Memoization plan; empty when the graph has no cache
+    enum Memo : uint8_t
+    {
+        Run,          // Not memoized
+        RunAndStore,  // Cache miss: run, then store the output
+        Skip,         // Cache hit, output not needed by anyone
+        SkipAndLoad   // Cache hit, output needed by a successor or the caller; fetched when planned
+    };
+    const std::vector<std::optional<MemoSpec>> *memo = nullptr;
+    ArtifactCache *cache = nullptr;
+    std::vector<uint8_t> plan;
+    std::vector<uint64_t> keys;
+    std::vector<std::string> artifacts; // Outputs of the SkipAndLoad nodes, by id
+    std::atomic<size_t> hits{0};
+    std::atomic<size_t> misses{0};
+
+    std::atomic<bool> failed{false};
+    std::exception_ptr firstError; // From spawned children, node bodies keep theirs in the promise
+
+    // Spawned subgraph: joins into the spawning scope and deletes itself
+    SpawnScope *parent = nullptr;
+    std::shared_ptr<TaskGraph> keepAlive;
+
+    // execute(): woken when the last node finishes
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool finished = false;
+
+    GraphRun(GraphLayout graphLayout, WorkStealingThreadPool &pool)
+        : layout(std::move(graphLayout)), pool(pool), nodes(new Node[layout.size()]),
+          remaining(new std::atomic<uint32_t>[layout.size()]), unfinished(layout.size() + 1)
+    {
+        for (uint32_t i = 0; i < layout.size(); ++i)
+        {
+            nodes[i].run = this;
+            nodes[i].index = i;
+            nodes[i].pool = &pool;
+            nodes[i].callback = &GraphRun::onComplete;
+            remaining[i].store(layout.indegree[i], std::memory_order_relaxed);
+        }
+    }
+
+    // Release every node without dependencies. `this` may be gone once this returns
+    void start()
+    {
+        for (uint32_t i = 0; i < layout.size(); ++i)
+        {
+            if (layout.indegree[i] == 0 && !release(i, UINT32_MAX))
+                finish(i);
+        }
+
+        // The whole run may have finished during the loop: only done() after it
+        if (unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            done();
+    }
+
+    /*
+    Hand node i, released by node `from`, to the pool:
+    - same cluster as `from` (or no partition): the calling worker's queue, the data is there
+    - otherwise the queue of the worker owning node i's cluster
+    Returns false if the task had already finished, in which case the caller
+    has to account for its completion itself. A task something else already
+    waits on (another node's body awaiting it) still reports to the node.
+    */
+    bool release(uint32_t i, uint32_t from)
+    {
+        if (!plan.empty() && (plan[i] == Skip || plan[i] == SkipAndLoad))
+        {
+            restore(i);
+            return false; // Counts as already finished
+        }
+
+        Task<void> &task = *layout.nodes[i];
+
+        if (!task.handle)
+            return false;
+
+        auto &promise = task.handle.promise();
+        if (!promise.attach(&nodes[i]))
+            return false; // Finished: attach only fails then
+
+        if (promise.try_start())
+        {
+            // Only the thread starting the coroutine may write its scope
+            promise.scope = &nodes[i];
+            if (executors && i < executors->size() && (*executors)[i])
+                (*executors)[i]->schedule(task.handle);
+            else if (home.empty() || (from != UINT32_MAX && home[from] == home[i]))
+                pool.schedule(task.handle);
+            else
+                pool.scheduleOn(home[i], task.handle);
+        }
+
+        return true; // Started elsewhere: the waiter still fires on completion
+    }
+
+    // Propagate the join of node i to its successors
+    void finish(uint32_t i)
+    {
+        std::vector<uint32_t> alreadyDone; // Only filled for tasks that finished before the run
+
+        while (true)
+        {
+            for (uint32_t next : layout.successors_of(i))
+            {
+                if (remaining[next].fetch_sub(1, std::memory_order_acq_rel) == 1 && !release(next, i))
+                    alreadyDone.push_back(next);
+            }
+
+            if (unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                done();
+                return;
+            }
+
+            if (alreadyDone.empty())
+                return;
+
+            i = alreadyDone.back();
+            alreadyDone.pop_back();
+        }
+    }
+
+    void fail(std::exception_ptr error) noexcept
+    {
+        if (!failed.exchange(true, std::memory_order_acq_rel))
+            firstError = std::move(error);
+    }
+
+    // First error of the run: a node body's, otherwise a spawned child's
+    std::exception_ptr error() const
+    {
+        for (Task<void> *task : layout.nodes)
+        {
+            if (task->handle && task->handle.promise().exception)
+                return task->handle.promise().exception;
+        }
+
+        return firstError;
+    }
+
+    // Last node joined. `this` may be gone once this returns
+    void done() noexcept
+    {
+        if (parent)
+        {
+            SpawnScope *scope = parent;
+            if (std::exception_ptr e = error())
+                scope->fail(e);
+
+            delete this;
+            scope->release();
+            return;
+        }
+
+        std::lock_guard lock(mtx);
+        finished = true;
+        cv.notify_all();
+    }
+
+    // The node body finished; its spawned work may still be running
+    // Cache hit: load the output fetched by plan_memo if someone needs it
+    void restore(uint32_t i)
+    {
+        if (plan[i] == SkipAndLoad)
+        {
+            try
+            {
+                (*memo)[i]->load(artifacts[i]);
+            }
+            catch (...)
+            {
+                fail(std::current_exception());
+            }
+            std::string().swap(artifacts[i]);
+        }
+
+        hits.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void store(uint32_t i) noexcept
+    {
+        Task<void> &task = *layout.nodes[i];
+        if (task.handle.promise().exception)
+            return; // Never cache a failed node
+
+        try
+        {
+            cache->put(keys[i], (*memo)[i]->save());
+        }
+        catch (...)
+        {
+            fail(std::current_exception());
+        }
+    }
+
+    static std::coroutine_handle<> onComplete(TaskWaiter *w) noexcept
+    {
+        auto *node = static_cast<Node *>(w);
+        GraphRun *run = node->run;
+        node->worker = run->pool.currentWorker();
+
+        if (!run->plan.empty() && run->plan[node->index] == RunAndStore)
+            run->store(node->index);
+
+        node->release();
+        return nullptr; // Dependents are scheduled on the pool, not transferred to
+    }
+};
+
+/*
+A task spawned from a running node. Owns the task, joins the spawning scope
+once the task and its own spawned work have finished, then deletes itself.
+*/
+struct SpawnedTask final : TaskWaiter, SpawnScope
 {
-    for (size_t i = 0; i < num_threads; ++i)
+    Task<void> task;
+    SpawnScope *parent;
+
+    SpawnedTask(Task<void> child, SpawnScope *parent) : task(std::move(child)), parent(parent)
+    {
+        pool = parent->pool;
+        callback = &SpawnedTask::onComplete;
+    }
+
+    void joined() noexcept override
+    {
+        SpawnScope *scope = parent;
+        delete this; // Also destroys the finished coroutine frame
+        scope->release();
+    }
+
+    void fail(std::exception_ptr error) noexcept override { parent->fail(std::move(error)); }
+
+    static std::coroutine_handle<> onComplete(TaskWaiter *w) noexcept
     {
-        workers.emplace_back([this]
-                             {
-                while (true)
-                {
-                    std::function<void()> task;
-                    {
-                        std::unique_lock lock(queue_mutex);
-                        condition.wait(lock, [this] { return !tasks.empty(); });
-                        task = std::move(tasks.front());
-                        tasks.pop();
-                    }
+        auto *self = static_cast<SpawnedTask *>(w);
 
-                    task();
-                } });
+        if (self->task.handle.promise().exception)
+            self->fail(self->task.handle.promise().exception);
+
+        static_cast<SpawnScope *>(self)->release();
+        return nullptr;
     }
+};
+
+// Tasks on a cycle would never become ready: reject them before starting anything
+void check_acyclic(const GraphLayout &layout, const char *caller)
+{
+    std::vector<uint32_t> cycle = find_cycle(layout);
+    if (cycle.empty())
+        return;
+
+    std::string message = std::string(caller) + ": dependency cycle detected:";
+    for (uint32_t id : cycle)
+        message += " " + std::to_string(id) + " ->";
+    message += " " + std::to_string(cycle.front());
+
+    throw GraphCycleError(message, std::move(cycle));
 }
 
-Thread_Pool::~Thread_Pool()
+/*
+Kahn pass over the nodes in [first, last) of `members` (all of them when the
+graph is checked as a whole). Edges never leave a weakly connected component,
+so passes over different components touch disjoint parts of `pending`.
+Returns the number of nodes that became ready.
+*/
+size_t kahn_pass(const GraphLayout &layout, const uint32_t *first, const uint32_t *last, std::vector<uint32_t> &pending)
 {
-    for (std::thread &worker : workers)
+    std::vector<uint32_t> ready;
+    for (const uint32_t *it = first; it != last; ++it)
     {
-        worker.detach();
+        if (pending[*it] == 0)
+            ready.push_back(*it);
     }
+
+    size_t visited = 0;
+    while (!ready.empty())
+    {
+        uint32_t i = ready.back();
+        ready.pop_back();
+        ++visited;
+
+        for (uint32_t next : layout.successors_of(i))
+        {
+            if (--pending[next] == 0)
+                ready.push_back(next);
+        }
+    }
+
+    return visited;
 }
 
-TaskGraph::TaskGraph(size_t num_threads) : pool(num_threads) {}
+// Weakly connected components with union-find (path halving); returns the members grouped per component
+std::vector<std::vector<uint32_t>> components_of(const GraphLayout &layout)
+{
+    const size_t n = layout.size();
+    std::vector<uint32_t> parent(n);
+    std::iota(parent.begin(), parent.end(), 0u);
 
-void TaskGraph::addTask(std::shared_ptr<Task<void>> task)
+    auto find = [&](uint32_t x)
+    {
+        while (parent[x] != x)
+        {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    };
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        for (uint32_t next : layout.successors_of(i))
+        {
+            uint32_t a = find(i), b = find(next);
+            if (a != b)
+                parent[std::max(a, b)] = std::min(a, b);
+        }
+    }
+
+    std::vector<uint32_t> slot(n, UINT32_MAX);
+    std::vector<std::vector<uint32_t>> groups;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        uint32_t root = find(i);
+        if (slot[root] == UINT32_MAX)
+        {
+            slot[root] = static_cast<uint32_t>(groups.size());
+            groups.emplace_back();
+        }
+        groups[slot[root]].push_back(i);
+    }
+
+    return groups;
+}
+
+/*
+Every node Kahn could not reach still has an unreached predecessor, so walking
+predecessors from any of them must run into a node already on the walk.
+*/
+std::vector<uint32_t> extract_cycle(const GraphLayout &layout, const std::vector<uint32_t> &pending)
 {
-    tasks.push_back(std::move(task));
+    const size_t n = layout.size();
+    uint32_t start = 0;
+    while (start < n && pending[start] == 0)
+        ++start;
+
+    std::vector<uint32_t> walk;
+    std::vector<uint32_t> position(n, UINT32_MAX);
+    uint32_t current = start;
+
+    while (position[current] == UINT32_MAX)
+    {
+        position[current] = static_cast<uint32_t>(walk.size());
+        walk.push_back(current);
+
+        for (uint32_t pred : layout.predecessors_of(current))
+        {
+            if (pending[pred] != 0)
+            {
+                current = pred;
+                break;
+            }
+        }
+    }
+
+    // The walk goes against the edges: reverse the loop into dependency order
+    std::vector<uint32_t> cycle(walk.begin() + position[current], walk.end());
+    std::reverse(cycle.begin(), cycle.end());
+    return cycle;
 }
 
-bool TaskGraph::has_cycle()
+// Cache key step: splitmix64 finalizer over the combined value
+uint64_t mix_key(uint64_t seed, uint64_t value)
 {
-    std::unordered_map<Task<void> *, int> visited;
+    uint64_t z = seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
 
-    for (auto &task : tasks)
+/*
+Decide, in topological order, which memoized nodes can be skipped:
+key = fingerprint mixed with the keys of all dependencies; a node with an
+unmemoized dependency has no key and always runs.
+The outputs to load are fetched here, not when the node is reached: one
+evicted in between would make the node run on inputs that were never loaded.
+*/
+void plan_memo(GraphRun &run, const std::vector<std::optional<MemoSpec>> &memo, ArtifactCache &cache)
+{
+    const GraphLayout &layout = run.layout;
+    const size_t n = layout.size();
+
+    run.memo = &memo;
+    run.cache = &cache;
+    run.plan.assign(n, GraphRun::Run);
+    run.keys.assign(n, 0);
+
+    std::vector<uint8_t> keyed(n, 0);
+    std::vector<uint32_t> pending(layout.indegree);
+    std::vector<uint32_t> ready;
+    std::vector<uint32_t> order; // Topological
+    order.reserve(n);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        if (pending[i] == 0)
+            ready.push_back(i);
+    }
+
+    while (!ready.empty())
+    {
+        uint32_t i = ready.back();
+        ready.pop_back();
+        order.push_back(i);
+
+        if (i < memo.size() && memo[i])
+        {
+            uint64_t key = mix_key(0, memo[i]->fingerprint);
+            bool allKeyed = true;
+            for (uint32_t pred : layout.predecessors_of(i))
+            {
+                allKeyed = allKeyed && keyed[pred];
+                key = mix_key(key, run.keys[pred]);
+            }
+
+            if (allKeyed)
+            {
+                keyed[i] = 1;
+                run.keys[i] = key;
+                run.plan[i] = cache.contains(key) ? GraphRun::Skip : GraphRun::RunAndStore;
+            }
+        }
+
+        for (uint32_t next : layout.successors_of(i))
+        {
+            if (--pending[next] == 0)
+                ready.push_back(next);
+        }
+    }
+
+    /*
+    A skipped output is only loaded for a successor that runs, or for the caller (sinks).
+    Successors first: a node whose output is gone by now runs instead, which in
+    turn needs the outputs of its own skipped dependencies.
+    */
+    run.artifacts.assign(n, std::string());
+    for (auto it = order.rbegin(); it != order.rend(); ++it)
     {
-        // if (detect_cycle(&task, visited))
-        if (detect_cycle(task.get(), visited))
-            return true; // There are cycles
+        uint32_t i = *it;
+        if (run.plan[i] != GraphRun::Skip)
+            continue;
+
+        bool needed = layout.successors_of(i).empty();
+        for (uint32_t next : layout.successors_of(i))
+            needed = needed || run.plan[next] == GraphRun::Run || run.plan[next] == GraphRun::RunAndStore;
+
+        if (!needed)
+            continue;
+
+        if (std::optional<std::string> artifact = cache.get(run.keys[i]))
+        {
+            run.plan[i] = GraphRun::SkipAndLoad;
+            run.artifacts[i] = std::move(*artifact);
+        }
+        else
+            run.plan[i] = GraphRun::RunAndStore;
     }
 
-    return false;
+    for (uint8_t p : run.plan)
+    {
+        if (p == GraphRun::RunAndStore)
+            run.misses.fetch_add(1, std::memory_order_relaxed);
+    }
+}
 }
 
-bool TaskGraph::detect_cycle(Task<void> *task, std::unordered_map<Task<void> *, int> &visited)
+GraphCycleError::GraphCycleError(const std::string &message, std::vector<uint32_t> cycle)
+    : std::logic_error(message), cycle(std::move(cycle)) {}
+
+std::vector<uint32_t> find_cycle(const GraphLayout &layout, size_t parallel_threshold)
 {
-    if (visited[task] == 1)
-        return true; // Visited
+    const size_t n = layout.size();
+    std::vector<uint32_t> pending(layout.indegree);
+    size_t visited = 0;
+
+    const size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::vector<uint32_t>> groups;
+    if (n >= parallel_threshold && threads > 1)
+        groups = components_of(layout);
 
-    if (visited[task] == 2)
-        return false; // Processing completed
+    if (groups.size() > 1)
+    {
+        // Largest components first, each to the least loaded bucket
+        std::sort(groups.begin(), groups.end(), [](const auto &a, const auto &b)
+                  { return a.size() > b.size(); });
+
+        const size_t bucketCount = std::min(threads, groups.size());
+        std::vector<std::vector<const std::vector<uint32_t> *>> buckets(bucketCount);
+        std::vector<size_t> load(bucketCount, 0);
+        for (const auto &group : groups)
+        {
+            size_t target = std::min_element(load.begin(), load.end()) - load.begin();
+            buckets[target].push_back(&group);
+            load[target] += group.size();
+        }
+
+        std::vector<std::future<size_t>> passes;
+        for (auto &bucket : buckets)
+        {
+            passes.push_back(std::async(std::launch::async, [&layout, &pending, &bucket]
+                                        {
+                size_t count = 0;
+                for (const auto *group : bucket)
+                    count += kahn_pass(layout, group->data(), group->data() + group->size(), pending);
+                return count; }));
+        }
 
-    visited[task] = 1; // Mark visiting
-    for (auto &dep : task->dependencies)
+        for (auto &pass : passes)
+            visited += pass.get();
+    }
+    else
     {
-        if (detect_cycle(dep, visited))
-            return true;
+        std::vector<uint32_t> all(n);
+        std::iota(all.begin(), all.end(), 0u);
+        visited = kahn_pass(layout, all.data(), all.data() + n, pending);
     }
 
-    visited[task] = 2;
-    return false;
+    if (visited == n)
+        return {};
+
+    return extract_cycle(layout, pending);
 }
 
-void TaskGraph::execute()
+size_t max_level_width(const GraphLayout &layout)
 {
-    std::unordered_map<Task<void> *, size_t> dependency_count;
-    std::queue<Task<void> *> ready_tasks;
+    const size_t n = layout.size();
+    std::vector<uint32_t> pending(layout.indegree);
+    std::vector<uint32_t> level(n, 0);
+    std::vector<uint32_t> ready;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        if (pending[i] == 0)
+            ready.push_back(i);
+    }
 
-    for (auto &task : tasks)
+    std::vector<size_t> width;
+    while (!ready.empty())
+    {
+        uint32_t i = ready.back();
+        ready.pop_back();
+
+        if (level[i] >= width.size())
+            width.resize(level[i] + 1, 0);
+        ++width[level[i]];
+
+        for (uint32_t next : layout.successors_of(i))
+        {
+            level[next] = std::max(level[next], level[i] + 1);
+            if (--pending[next] == 0)
+                ready.push_back(next);
+        }
+    }
+
+    return width.empty() ? 0 : *std::max_element(width.begin(), width.end());
+}
+
+std::vector<uint32_t> partition_for_locality(const GraphLayout &layout, size_t workers)
+{
+    const size_t n = layout.size();
+    workers = std::max<size_t>(1, workers);
+
+    // Pass 1, in topological order: cluster ids
+    std::vector<uint32_t> cluster(n, 0);
+    std::vector<uint32_t> clusterSize;
+    std::vector<uint8_t> continued(n, 0); // The node's cluster already went on to one successor
+    std::vector<uint32_t> votes;          // Scratch for fan-in majorities
+    std::vector<uint32_t> touched;
+
+    auto newCluster = [&]
     {
-        size_t count = task->dependencies.size();
-        // dependency_count[&task] = count;
-        dependency_count[task.get()] = count;
+        clusterSize.push_back(0);
+        votes.push_back(0);
+        return static_cast<uint32_t>(clusterSize.size() - 1);
+    };
 
-        if (count == 0)
-            // ready_tasks.push(&task);
-            ready_tasks.push(task.get());
+    std::vector<uint32_t> pending(layout.indegree);
+    std::vector<uint32_t> ready;
+    std::vector<uint32_t> order; // Topological
+    order.reserve(n);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        if (pending[i] == 0)
+            ready.push_back(i);
     }
 
-    while (!ready_tasks.empty())
+    while (!ready.empty())
     {
-        Task<void> *task = ready_tasks.front();
-        ready_tasks.pop();
-        pool.enqueue([task]
-                     { task->execute(); });
+        uint32_t i = ready.back();
+        ready.pop_back();
+        order.push_back(i);
+
+        auto preds = layout.predecessors_of(i);
+        uint32_t c;
 
-        for (auto &next_task : tasks)
+        if (preds.empty())
+            c = newCluster();
+        else if (preds.size() == 1)
+        {
+            // Chain link, or the first branch of a fan-out: stay with the predecessor
+            uint32_t p = preds[0];
+            c = continued[p] ? newCluster() : cluster[p];
+            continued[p] = 1;
+        }
+        else
         {
-            if (std::find(next_task->dependencies.begin(), next_task->dependencies.end(), task) != next_task->dependencies.end())
+            // Fan-in: join the cluster holding most of the inputs
+            c = cluster[preds[0]];
+            for (uint32_t p : preds)
             {
-                // if (--dependency_count[&next_task] == 0)
-                // ready_tasks.push(&next_task);
-
-                if (--dependency_count[next_task.get()] == 0)
-                    ready_tasks.push(next_task.get());
+                if (votes[cluster[p]]++ == 0)
+                    touched.push_back(cluster[p]);
+                if (votes[cluster[p]] > votes[c])
+                    c = cluster[p];
             }
+
+            for (uint32_t t : touched)
+                votes[t] = 0;
+            touched.clear();
+        }
+
+        cluster[i] = c;
+        ++clusterSize[c];
+
+        for (uint32_t next : layout.successors_of(i))
+        {
+            if (--pending[next] == 0)
+                ready.push_back(next);
+        }
+    }
+
+    // Pass 2: each cluster, in creation order, to the least loaded worker
+    using Load = std::pair<size_t, uint32_t>;
+    std::priority_queue<Load, std::vector<Load>, std::greater<Load>> loads;
+    for (uint32_t w = 0; w < workers; ++w)
+        loads.emplace(0, w);
+
+    std::vector<uint32_t> clusterWorker(clusterSize.size());
+    for (size_t c = 0; c < clusterSize.size(); ++c)
+    {
+        auto [load, w] = loads.top();
+        loads.pop();
+        clusterWorker[c] = w;
+        loads.emplace(load + clusterSize[c], w);
+    }
+
+    std::vector<uint32_t> home(n);
+    for (uint32_t i = 0; i < n; ++i)
+        home[i] = clusterWorker[cluster[i]];
+
+    return home;
+}
+
+void Spawner::spawn(Task<void> child)
+{
+    if (!child.handle)
+        return;
+
+    scope->outstanding.fetch_add(1, std::memory_order_relaxed); // Before the child can finish
+
+    auto *spawned = new SpawnedTask(std::move(child), scope);
+    auto &promise = spawned->task.handle.promise();
+    if (!promise.attach(spawned))
+    {
+        SpawnedTask::onComplete(spawned); // Already finished
+        return;
+    }
+
+    if (promise.try_start())
+    {
+        promise.scope = spawned;
+        scope->pool->schedule(spawned->task.handle);
+    }
+}
+
+void Spawner::spawn(std::shared_ptr<TaskGraph> subgraph)
+{
+    if (!subgraph || subgraph->tasks.empty())
+        return;
+
+    GraphLayout layout = subgraph->compile();
+    check_acyclic(layout, "Spawner::spawn");
+
+    scope->outstanding.fetch_add(1, std::memory_order_relaxed);
+
+    auto *run = new GraphRun(std::move(layout), *scope->pool);
+    run->parent = scope;
+    run->keepAlive = std::move(subgraph);
+    run->start();
+}
+
+
+TaskGraph::TaskGraph(size_t num_threads) : num_threads(num_threads) {}
+
+void TaskGraph::addTask(std::shared_ptr<Task<void>> task)
+{
+    task->graph_index = tasks.size();
+    tasks.push_back(std::move(task));
+}
+
+void TaskGraph::addTask(std::shared_ptr<Task<void>> task, NodeExecutor &executor)
+{
+    if (executors.size() < tasks.size() + 1)
+        executors.resize(tasks.size() + 1, nullptr);
+
+    executors[tasks.size()] = &executor;
+    addTask(std::move(task));
+}
+
+void TaskGraph::memoize(const Task<void> &task, MemoSpec spec)
+{
+    size_t id = task.graph_index;
+    if (id >= tasks.size() || tasks[id].get() != &task)
+        throw std::invalid_argument("TaskGraph::memoize: task was not added to this graph");
+
+    if (!spec.save || !spec.load)
+        throw std::invalid_argument("TaskGraph::memoize: save and load are required");
+
+    if (memo.size() < tasks.size())
+        memo.resize(tasks.size());
+
+    memo[id] = std::move(spec);
+}
+
+std::string GraphRunStats::summary() const
+{
+    std::string text = "nodes = " + std::to_string(nodes) + ", edges = " + std::to_string(edges) +
+                       ", cross-worker edges = " + std::to_string(cross_worker_edges);
+
+    if (cache_hits + cache_misses > 0)
+    {
+        text += ", cache hits = " + std::to_string(cache_hits) + ", misses = " + std::to_string(cache_misses) +
+                " (" + std::to_string(static_cast<int>(cache_hit_rate() * 100 + 0.5)) + "% hit rate)";
+    }
+
+    return text;
+}
+
+GraphLayout TaskGraph::compile() const
+{
+    const size_t n = tasks.size();
+    if (n >= UINT32_MAX)
+        throw std::length_error("TaskGraph::compile: too many tasks");
+
+    GraphLayout layout;
+    layout.nodes.reserve(n);
+    for (auto &task : tasks)
+        layout.nodes.push_back(task.get());
+
+    // Dense id of a dependency, or n if it was never added to this graph
+    auto idOf = [&](Task<void> *dep) -> size_t
+    {
+        size_t id = dep ? dep->graph_index : n;
+        return (id < n && layout.nodes[id] == dep) ? id : n;
+    };
+
+    // Pass 1: degrees
+    layout.succ_offsets.assign(n + 1, 0);
+    layout.pred_offsets.assign(n + 1, 0);
+    layout.indegree.assign(n, 0);
+    for (size_t i = 0; i < n; ++i)
+    {
+        for (Task<void> *dep : tasks[i]->dependencies)
+        {
+            size_t d = idOf(dep);
+            if (d == n)
+                continue; // Not part of this graph
+
+            ++layout.succ_offsets[d + 1];
+            ++layout.indegree[i];
+        }
+        layout.pred_offsets[i + 1] = layout.indegree[i];
+    }
+
+    // Pass 2: prefix sums
+    for (size_t i = 0; i < n; ++i)
+    {
+        layout.succ_offsets[i + 1] += layout.succ_offsets[i];
+        layout.pred_offsets[i + 1] += layout.pred_offsets[i];
+    }
+
+    // Pass 3: fill both directions
+    layout.successors.resize(layout.succ_offsets[n]);
+    layout.predecessors.resize(layout.pred_offsets[n]);
+    std::vector<uint32_t> cursor(layout.succ_offsets.begin(), layout.succ_offsets.end() - 1);
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint32_t p = layout.pred_offsets[i];
+        for (Task<void> *dep : tasks[i]->dependencies)
+        {
+            size_t d = idOf(dep);
+            if (d == n)
+                continue;
+
+            layout.successors[cursor[d]++] = static_cast<uint32_t>(i);
+            layout.predecessors[p++] = static_cast<uint32_t>(d);
+        }
+    }
+
+    return layout;
+}
+
+bool TaskGraph::has_cycle() const
+{
+    return !find_cycle().empty();
+}
+
+std::vector<uint32_t> TaskGraph::find_cycle() const
+{
+    return ::find_cycle(compile());
+}
+
+void TaskGraph::execute()
+{
+    if (!pool)
+        pool = std::make_unique<WorkStealingThreadPool>(std::max<size_t>(1, num_threads));
+
+    execute(*pool);
+}
+
+void TaskGraph::execute(WorkStealingThreadPool &workers)
+{
+    if (tasks.empty())
+        return;
+
+    execute(workers, compile());
+}
+
+void TaskGraph::execute(WorkStealingThreadPool &workers, GraphLayout layout)
+{
+    if (layout.size() == 0)
+        return;
+
+    check_acyclic(layout, "TaskGraph::execute");
+
+    GraphRun run(std::move(layout), workers);
+    if (locality && workers.size() > 1)
+        run.home = partition_for_locality(run.layout, workers.size());
+    if (cache && !memo.empty())
+        plan_memo(run, memo, *cache);
+    if (!executors.empty())
+        run.executors = &executors;
+
+    run.start();
+
+    // Called from a node on `workers` (a nested graph), the worker keeps running nodes meanwhile
+    wait_helping(run.mtx, run.cv, [&]
+                 { return run.finished; });
+
+    last_run = GraphRunStats{};
+    last_run.nodes = run.layout.size();
+    last_run.edges = run.layout.successors.size();
+    last_run.cache_hits = run.hits.load();
+    last_run.cache_misses = run.misses.load();
+    for (uint32_t i = 0; i < run.layout.size(); ++i)
+    {
+        if (run.nodes[i].worker == SIZE_MAX)
+            continue; // Skipped
+
+        for (uint32_t next : run.layout.successors_of(i))
+        {
+            if (run.nodes[next].worker != SIZE_MAX && run.nodes[i].worker != run.nodes[next].worker)
+                ++last_run.cross_worker_edges;
         }
     }
+
+    if (std::exception_ptr e = run.error())
+        std::rethrow_exception(e);
 }
 
 void TaskGraph::wait_all()
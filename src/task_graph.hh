@@ -1,53 +1,269 @@
 #pragma once
 
+#include "InplaceFunction.hh"
+#include "artifact_cache.hh"
 #include "task.hh"
+#include "WorkStealing.hh"
+
+#include <cstdint>
 #include <functional>
-#include <queue>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
 #include <unordered_map>
 
-class Thread_Pool
+/*
+Flat, compiled form of a TaskGraph.
+- node ids are dense (0..n-1, the order tasks were added)
+- successors / predecessors use CSR: the neighbours of node i are
+  successors[succ_offsets[i] .. succ_offsets[i + 1]), same for predecessors
+- indegree[i] is the number of predecessors of node i
+Built with a few linear passes over the tasks, without any hash map.
+*/
+struct GraphLayout
 {
-public:
-    Thread_Pool(size_t num_threads);
+    std::vector<Task<void> *> nodes;
+    std::vector<uint32_t> succ_offsets;
+    std::vector<uint32_t> successors;
+    std::vector<uint32_t> pred_offsets;
+    std::vector<uint32_t> predecessors;
+    std::vector<uint32_t> indegree;
+
+    size_t size() const { return nodes.size(); }
+
+    std::span<const uint32_t> successors_of(size_t i) const
+    {
+        return {successors.data() + succ_offsets[i], successors.data() + succ_offsets[i + 1]};
+    }
+
+    std::span<const uint32_t> predecessors_of(size_t i) const
+    {
+        return {predecessors.data() + pred_offsets[i], predecessors.data() + pred_offsets[i + 1]};
+    }
+};
+
+/*
+Join counter of a running graph node (or of work spawned from one).
+- outstanding = 1 for the body itself + spawned children that have not finished
+- joined() runs when it drops to zero: a node releases its successors, a child
+  reports to the scope that spawned it
+*/
+struct SpawnScope
+{
+    WorkStealingThreadPool *pool = nullptr;
+    std::atomic<size_t> outstanding{1};
 
-    template <typename F>
-    void enqueue(F &&task)
+    virtual void joined() noexcept = 0;
+
+    // A spawned child failed; the error reaches the TaskGraph::execute() caller
+    virtual void fail(std::exception_ptr error) noexcept = 0;
+
+    void release() noexcept
     {
-        {
-            std::unique_lock lock(queue_mutex);
-            tasks.push(std::forward<F>(task));
-        }
+        if (outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            joined();
+    }
+
+protected:
+    ~SpawnScope() = default;
+};
+
+// Thrown before execution when the dependencies form a cycle
+struct GraphCycleError : std::logic_error
+{
+    std::vector<uint32_t> cycle; // Dense ids along the cycle, each a dependency of the next
+
+    GraphCycleError(const std::string &message, std::vector<uint32_t> cycle);
+};
+
+/*
+Iterative validation with Kahn's algorithm over the dense ids (no recursion, no hashing).
+Returns an empty vector for a DAG, otherwise one cycle in dependency order.
+Graphs with at least `parallel_threshold` nodes are checked per weakly
+connected component, the components spread over the hardware threads.
+*/
+std::vector<uint32_t> find_cycle(const GraphLayout &layout, size_t parallel_threshold = 1 << 16);
+
+/*
+Widest level of the graph (nodes grouped by longest path from a source): a
+cheap lower bound on its maximum antichain, i.e. how many workers it can use.
+Expects an acyclic layout.
+*/
+size_t max_level_width(const GraphLayout &layout);
+
+/*
+Locality partition: the worker whose queue each node should start from.
+- a node with a single input continues its input's cluster (chains, and the
+  first branch of a fan-out); other fan-out branches start new clusters
+- a fan-in node joins the cluster holding most of its inputs
+- clusters go, in creation order, to the least loaded worker
+Expects an acyclic layout.
+*/
+std::vector<uint32_t> partition_for_locality(const GraphLayout &layout, size_t workers);
 
-        condition.notify_one();
+// What the last TaskGraph::execute() did
+struct GraphRunStats
+{
+    size_t nodes = 0;
+    size_t edges = 0;
+    size_t cross_worker_edges = 0; // Edges whose two tasks finished on different workers
+
+    // Memoized nodes (TaskGraph::memoize) only
+    size_t cache_hits = 0;   // Skipped: output restored from the cache, or not needed at all
+    size_t cache_misses = 0; // Ran and stored their output
+
+    double cache_hit_rate() const
+    {
+        size_t lookups = cache_hits + cache_misses;
+        return lookups ? static_cast<double>(cache_hits) / lookups : 0.0;
     }
 
-    ~Thread_Pool();
+    std::string summary() const;
+};
+
+/*
+Memoization of one graph node, like a target in an incremental build.
+- fingerprint: hash of the node's own inputs (file contents, parameters...)
+- the cache key also folds in the keys of its dependencies, so a changed
+  input invalidates everything downstream of it
+- save serializes the output after the node ran, load restores it on a hit
+A node whose dependencies are not all memoized always runs.
+*/
+struct MemoSpec
+{
+    uint64_t fingerprint = 0;
+    UniqueFunction<std::string()> save;
+    UniqueFunction<void(const std::string &)> load;
+};
+
+/*
+Somewhere other than the graph's pool to run a node, e.g. an I/O context.
+schedule() must not block: it is called on whichever thread released the node.
+*/
+struct NodeExecutor
+{
+    virtual void schedule(std::coroutine_handle<> handle) = 0;
+
+protected:
+    ~NodeExecutor() = default;
+};
+
+struct TaskGraph;
+
+/*
+Adds work to the live graph from inside a running node.
+- spawned tasks and subgraphs go to the calling worker's own queue
+- the node only counts as finished (and releases its successors) once its body
+  and everything it spawned, recursively, have finished
+*/
+class Spawner
+{
+public:
+    explicit Spawner(SpawnScope *scope) : scope(scope) {}
+
+    void spawn(Task<void> child);
+
+    // Runs the subgraph's tasks on the same pool; throws std::logic_error on a cycle
+    void spawn(std::shared_ptr<TaskGraph> subgraph);
 
 private:
-    std::vector<std::thread> workers;
-    std::queue<std::function<void()>> tasks;
-    std::mutex queue_mutex;
-    std::condition_variable condition;
+    SpawnScope *scope;
+};
+
+// Awaiter behind TaskGraph::spawner(): never suspends, only reads the scope from the caller's promise
+struct SpawnerAwaiter
+{
+    SpawnScope *scope = nullptr;
+
+    bool await_ready() const noexcept { return false; }
+
+    template <typename P>
+    bool await_suspend(std::coroutine_handle<P> h) noexcept
+    {
+        if constexpr (std::is_base_of_v<TaskPromiseBase, P>)
+            scope = h.promise().scope;
+
+        return false;
+    }
+
+    Spawner await_resume() const
+    {
+        if (!scope)
+            throw std::logic_error("TaskGraph::spawner: not inside a running graph node");
+
+        return Spawner(scope);
+    }
 };
 
 struct TaskGraph
 {
     // std::vector<Task<void>> tasks;
     std::vector<std::shared_ptr<Task<void>>> tasks; // List of Tasks to manage coroutines
-    Thread_Pool pool;
+    std::unique_ptr<WorkStealingThreadPool> pool;   // Created by the first execute(), reused afterwards
+    size_t num_threads;
+
+    // Keep chains and fan-in clusters on one worker's queue (stealing still balances the load)
+    bool locality = true;
+    GraphRunStats last_run;
+
+    // Memoized nodes are looked up here when set, skipped on a hit and stored on a miss
+    std::shared_ptr<ArtifactCache> cache;
+    std::vector<std::optional<MemoSpec>> memo; // By task id
+
+    // Declare a task (already added) memoizable. Skipped tasks are never started
+    void memoize(const Task<void> &task, MemoSpec spec);
 
     TaskGraph(size_t num_threads) ;
 
+    // Adds the task and gives it the next dense id (a task belongs to one graph at a time)
     void addTask(std::shared_ptr<Task<void>> task);
 
-    bool has_cycle();
+    // Same, but the task is started on `executor` instead of the pool (which must outlive the runs)
+    void addTask(std::shared_ptr<Task<void>> task, NodeExecutor &executor);
+
+    std::vector<NodeExecutor *> executors; // By task id, nullptr (or missing): the pool
+
+    /*
+    Build the CSR layout of the current tasks and dependencies.
+    Dependencies on tasks that were not added to this graph are ignored.
+    */
+    GraphLayout compile() const;
+
+    bool has_cycle() const;
 
-    bool detect_cycle(Task<void> *task, std::unordered_map<Task<void> *, int> &visited);
+    // Ids (positions in `tasks`) along one dependency cycle, empty if there is none
+    std::vector<uint32_t> find_cycle() const;
 
+    // Run every task once its dependencies have finished, on num_threads workers
     void execute();
 
-    void wait_all();
-};
+    /*
+    Completion-driven execution on an existing pool:
+    - the graph is compiled once per run (CSR layout, O(V + E))
+    - a task is released by the completion of its last dependency, never by
+      blocking a worker on `dep->wait()`
+    - released tasks go to the completing worker's own queue, or to the worker
+      owning their cluster when `locality` puts them in another one
+    - a running task can spawn more work (see spawner()); it only counts as
+      finished once that work has finished too
+    - with a cache, memoized tasks whose key is stored are skipped; their output
+      is only loaded when an unskipped successor (or the caller, for sinks) needs it
+    Blocks until every task has finished; rethrows the first task exception.
+    Dependencies on tasks that were not added to the graph are ignored.
+    Throws GraphCycleError (a std::logic_error) if the dependencies form a cycle.
+    */
+    void execute(WorkStealingThreadPool &workers);
 
+    // Same, with a layout already built by compile()
+    void execute(WorkStealingThreadPool &workers, GraphLayout layout);
 
+    void wait_all();
 
+    /*
+    `Spawner spawner = co_await TaskGraph::spawner();` inside a node body (or a
+    Task it awaits) while the graph runs. Throws std::logic_error elsewhere.
+    */
+    static SpawnerAwaiter spawner() { return {}; }
+};
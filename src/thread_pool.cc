@@ -10,7 +10,7 @@ ThreadPool::ThreadPool(size_t numThreads) : stop(false)
                              {
             while (true) 
             {
-                function<void()> task;
+                UniqueFunction<void()> task;
 
                 {
                     unique_lock lock(queue_mutex);
@@ -24,21 +24,19 @@ ThreadPool::ThreadPool(size_t numThreads) : stop(false)
                     jobs.pop();
                 }
 
-                task();
+                task(); // Run coroutine
+
+                lock_guard lock(completion_mutex);
+                completed_jobs.push_back(this_thread::get_id()); // Track completed thread
             } });
     }
 }
 
-void ThreadPool::enqueue(function<void()> job)
+void ThreadPool::enqueue(UniqueFunction<void()> job)
 {
     {
         lock_guard lock(queue_mutex);
-        jobs.emplace([job, this]()
-                     {
-                         job(); // Run coroutine
-                         lock_guard lock(completion_mutex);
-                         completed_jobs.push_back(this_thread::get_id()); // Track completed thread
-                     });
+        jobs.push(std::move(job)); // Completion is tracked by the worker, no wrapping closure to allocate
     }
 
     cv.notify_one(); // 🔔 Wake up an idle thread
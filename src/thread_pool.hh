@@ -7,6 +7,8 @@
 #include <condition_variable>
 #include <atomic>
 
+#include "InplaceFunction.hh"
+
 using namespace std;
 
 class ThreadPool
@@ -15,13 +17,13 @@ public:
     explicit ThreadPool(size_t numThreads);
     ~ThreadPool();
 
-    void enqueue(function<void()> job);
+    void enqueue(UniqueFunction<void()> job);
 
 private:
     // List of worker threads
     vector<thread> workers;
     // Queue jobs
-    queue<function<void()>> jobs;
+    queue<UniqueFunction<void()>> jobs;
     mutex queue_mutex;
     mutex completion_mutex;
     condition_variable cv;
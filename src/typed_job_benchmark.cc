@@ -0,0 +1,145 @@
+#include "JobBuilder.hh"
+#include "JobDispatcher.hh"
+#include "JobExecutor.hh"
+
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <thread>
+
+namespace fs = filesystem;
+
+/*
+Per-job overhead of a Job (type-erased task and callbacks, run by JobExecutor)
+against a TypedJob (task and callbacks stored by value)
+- every job carries the same trivial task plus onStart / onResult / onComplete
+  (JobExecutor does not call onComplete; TypedJob does)
+- "build+run": stamping the job from a builder and running it on this thread;
+  the Job row goes through JobExecutor (its console lines are muted),
+  "erased" converts the TypedJob into its Job node first, as dispatch does
+- "dispatch": creating, dispatching and running every job on a JobDispatcher
+- allocations are counted through a global operator new
+Usage: typed_job_benchmark [jobs=200000] [threads=2] [runs=5]
+*/
+
+static atomic<size_t> allocations{0};
+
+void *operator new(size_t size)
+{
+    allocations.fetch_add(1, memory_order_relaxed);
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+int main(int argc, char **argv)
+{
+    size_t jobs = argc > 1 ? stoul(argv[1]) : 200'000;
+    int threads = argc > 2 ? max(1, stoi(argv[2])) : 2;
+    size_t runs = argc > 3 ? max<size_t>(1, stoul(argv[3])) : 5;
+
+    fs::create_directories("result");
+    ofstream csv("result/typed_job_benchmark_result.csv");
+    csv << "stage,job,jobs,best_ms,ns_per_job,allocations_per_job\n";
+
+    atomic<size_t> done{0};
+    atomic<size_t> sink{0}; // Keeps the callbacks observable; workers add to it too
+
+    // Jobs run by JobExecutor log one console line each: mute them while measuring
+    auto measure = [&](const string &stage, const string &kind, bool executor, auto body)
+    {
+        double best = 1e300;
+        size_t allocated = 0;
+
+        for (size_t run = 0; run < runs; ++run)
+        {
+            done = 0;
+            size_t before = allocations.load();
+            if (executor)
+                cout.setstate(ios::failbit);
+            auto start = chrono::steady_clock::now();
+            body();
+            chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+            cout.clear();
+            allocated = allocations.load() - before;
+            best = min(best, elapsed.count());
+        }
+
+        double nsPerJob = best * 1e6 / jobs;
+        double allocsPerJob = static_cast<double>(allocated) / jobs;
+        csv << stage << "," << kind << "," << jobs << "," << best << "," << nsPerJob << "," << allocsPerJob << "\n";
+        cout << "[" << stage << "] " << kind << ": " << nsPerJob << " ns per job, "
+             << allocsPerJob << " allocations per job\n";
+    };
+
+    auto task = [&]
+    { sink.fetch_add(1, memory_order_relaxed); };
+
+    JobBuilder erased;
+    erased.onStart([&]
+                   { sink.fetch_add(2, memory_order_relaxed); })
+        .onResult([&](const JobResult &r)
+                  { sink.fetch_add(r.attempts, memory_order_relaxed); done.fetch_add(1, memory_order_relaxed); })
+        .onComplete([&](bool success, int, long long)
+                    { sink.fetch_add(success, memory_order_relaxed); });
+
+    auto typed = JobBuilder::typed()
+                     .onStart([&]
+                              { sink.fetch_add(2, memory_order_relaxed); })
+                     .onResult([&](const JobResult &r)
+                               { sink.fetch_add(r.attempts, memory_order_relaxed); done.fetch_add(1, memory_order_relaxed); })
+                     .onComplete([&](bool success, int, long long)
+                                 { sink.fetch_add(success, memory_order_relaxed); });
+
+    measure("build+run", "Job", true, [&]
+            {
+        for (size_t i = 0; i < jobs; ++i)
+        {
+            Job job = erased.build(task);
+            JobExecutor::execute(job);
+        } });
+
+    measure("build+run", "TypedJob", false, [&]
+            {
+        for (size_t i = 0; i < jobs; ++i)
+            typed.build(task).run(); });
+
+    measure("build+run", "TypedJob erased", false, [&]
+            {
+        for (size_t i = 0; i < jobs; ++i)
+            typed.build(task).toJob()->tasks(); });
+
+    // Every job reports its onResult once
+    auto wait = [&]
+    {
+        while (done.load() < jobs)
+            this_thread::yield();
+    };
+
+    {
+        JobDispatcher dispatcher(threads);
+
+        measure("dispatch", "Job", true, [&]
+                {
+            for (size_t i = 0; i < jobs; ++i)
+                dispatcher.dispatch(static_cast<int>(i % threads), make_unique<Job>(erased.build(task)));
+            wait(); });
+
+        measure("dispatch", "TypedJob", false, [&]
+                {
+            for (size_t i = 0; i < jobs; ++i)
+                dispatcher.dispatch(static_cast<int>(i % threads), typed.build(task));
+            wait(); });
+
+        dispatcher.stop();
+    }
+
+    cout << "\n Typed job benchmark complete (checksum " << sink.load() << ").\n";
+    cout << "CSV:     result/typed_job_benchmark_result.csv\n";
+}
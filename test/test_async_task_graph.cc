@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include "../src/async_task.hh"
+
+#include <atomic>
+#include <chrono>
+
+using namespace std;
+
+TEST(AsyncTaskGraphTest, IoNodesRunOnIoThreadsAndCpuNodesOnThePool)
+{
+    AsyncTaskGraph graph(2, 2);
+    bool ioOnIoThread = false;
+    bool cpuOnPool = false;
+
+    auto io = make_shared<Task<void>>([](AsyncTaskGraph &graph, bool &onIo) -> Task<void>
+                                      {
+        co_await graph.io.sleep(chrono::milliseconds(10));
+        onIo = graph.io.get_io_context().get_executor().running_in_this_thread(); }(graph, ioOnIoThread));
+
+    auto cpu = make_shared<Task<void>>([](AsyncTaskGraph &graph, bool &onPool) -> Task<void>
+                                       {
+        onPool = graph.pool->currentWorker() != SIZE_MAX;
+        co_return; }(graph, cpuOnPool));
+
+    cpu->dependsOn(*io);
+    graph.addTask(io, NodeKind::Io);
+    graph.addTask(cpu);
+
+    graph.execute();
+
+    EXPECT_TRUE(ioOnIoThread);
+    EXPECT_TRUE(cpuOnPool);
+}
+
+static Task<void> waitOnTimer(AsyncIOContext &io, atomic<int> &done)
+{
+    co_await io.sleep(chrono::milliseconds(100));
+    done.fetch_add(1);
+}
+
+TEST(AsyncTaskGraphTest, PendingIoDoesNotHoldThreads)
+{
+    AsyncTaskGraph graph(1, 1);
+    atomic<int> done{0};
+
+    for (int i = 0; i < 8; ++i)
+        graph.addTask(make_shared<Task<void>>(waitOnTimer(graph.io, done)), NodeKind::Io);
+
+    auto start = chrono::steady_clock::now();
+    graph.execute();
+    auto elapsed = chrono::steady_clock::now() - start;
+
+    // One io thread, eight 100 ms timers: they overlap instead of queueing
+    EXPECT_EQ(done.load(), 8);
+    EXPECT_LT(elapsed, chrono::milliseconds(600));
+}
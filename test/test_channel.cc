@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+
+#include "../src/async_generator.hh"
+#include "../src/channel.hh"
+
+#include <atomic>
+#include <chrono>
+#include <numeric>
+
+using namespace std;
+
+static AsyncGenerator<int> countTo(int n)
+{
+    for (int i = 1; i <= n; ++i)
+    {
+        if (i % 2 == 0)
+            co_await sleepAsync(chrono::milliseconds(1)); // Suspend between values
+
+        co_yield i;
+    }
+}
+
+static AsyncGenerator<int> failAfterOne()
+{
+    co_yield 1;
+    throw runtime_error("generator failed");
+}
+
+TEST(ChannelTest, GeneratorYieldsEveryValue)
+{
+    auto consume = []() -> Task<int>
+    {
+        auto gen = countTo(10);
+        int sum = 0;
+
+        while (auto value = co_await gen.next())
+            sum += *value;
+
+        co_return sum;
+    };
+
+    auto task = consume();
+    EXPECT_EQ(task.get(), 55);
+}
+
+TEST(ChannelTest, GeneratorRethrowsProducerException)
+{
+    auto consume = []() -> Task<void>
+    {
+        auto gen = failAfterOne();
+        while (co_await gen.next())
+        {
+        }
+    };
+
+    auto task = consume();
+    EXPECT_THROW(task.get(), runtime_error);
+}
+
+TEST(ChannelTest, BoundedSendSuspendsUntilReceived)
+{
+    Channel<int> ch(2);
+    int sentBeforeReceive = 0;
+
+    auto produce = [&]() -> Task<void>
+    {
+        for (int i = 0; i < 5; ++i)
+        {
+            co_await ch.send(i);
+            sentBeforeReceive++;
+        }
+        ch.close();
+    };
+
+    auto producer = produce();
+    producer.start().resume(); // Fills the buffer, then suspends on the third send
+
+    EXPECT_EQ(sentBeforeReceive, 2);
+
+    auto consume = [&]() -> Task<vector<int>>
+    {
+        vector<int> values;
+        while (auto value = co_await ch.receive())
+            values.push_back(*value);
+        co_return values;
+    };
+
+    auto consumer = consume();
+    EXPECT_EQ(consumer.get(), (vector<int>{0, 1, 2, 3, 4}));
+    producer.wait();
+}
+
+TEST(ChannelTest, SendOnClosedChannelFails)
+{
+    Channel<int> ch(1);
+    ch.close();
+
+    auto send = [&]() -> Task<bool>
+    {
+        co_return co_await ch.send(1);
+    };
+
+    auto task = send();
+    EXPECT_FALSE(task.get());
+
+    int value = 2;
+    EXPECT_FALSE(ch.trySend(value));
+    EXPECT_FALSE(ch.tryReceive().has_value());
+}
+
+TEST(ChannelTest, PipelineOnPoolDeliversEverything)
+{
+    WorkStealingThreadPool pool(4);
+    Channel<int> ch(8, &pool);
+    atomic<long long> total{0};
+    const int producers = 4, perProducer = 1000, consumers = 3;
+
+    auto produce = [&](int base) -> Task<void>
+    {
+        co_await pool.schedule();
+        for (int i = 0; i < perProducer; ++i)
+            co_await ch.send(base + i);
+    };
+
+    auto consume = [&]() -> Task<void>
+    {
+        co_await pool.schedule();
+        while (auto value = co_await ch.receive())
+            total += *value;
+    };
+
+    auto closeWhenSent = [&](vector<Task<void>> senders) -> Task<void>
+    {
+        co_await when_all(std::move(senders));
+        ch.close(); // Everything is buffered or delivered: consumers drain and stop
+    };
+
+    auto drain = [&](vector<Task<void>> receivers) -> Task<void>
+    {
+        co_await when_all(std::move(receivers));
+    };
+
+    auto run = [&]() -> Task<void>
+    {
+        vector<Task<void>> senders;
+        for (int p = 0; p < producers; ++p)
+            senders.push_back(produce(p * perProducer));
+
+        vector<Task<void>> receivers;
+        for (int c = 0; c < consumers; ++c)
+            receivers.push_back(consume());
+
+        co_await when_all(closeWhenSent(std::move(senders)), drain(std::move(receivers)));
+    };
+
+    auto task = run();
+    task.get();
+
+    const long long n = producers * perProducer;
+    EXPECT_EQ(total.load(), n * (n - 1) / 2);
+}
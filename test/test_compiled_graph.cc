@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include "../src/compiled_graph.hh"
+
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+TEST(CompiledGraphTest, RunsDependenciesFirstOnEveryRun)
+{
+    WorkStealingThreadPool pool(4);
+    CompiledGraph graph;
+
+    mutex mtx;
+    vector<int> order;
+    auto record = [&](int id)
+    {
+        return [&, id]
+        {
+            lock_guard<mutex> lock(mtx);
+            order.push_back(id);
+        };
+    };
+
+    // Diamond: 0 -> {1, 2} -> 3
+    auto a = graph.addNode(record(0));
+    auto b = graph.addNode(record(1));
+    auto c = graph.addNode(record(2));
+    auto d = graph.addNode(record(3));
+    graph.dependsOn(b, a);
+    graph.dependsOn(c, a);
+    graph.dependsOn(d, b);
+    graph.dependsOn(d, c);
+
+    for (int run = 0; run < 50; ++run)
+    {
+        order.clear();
+        graph.run(pool);
+
+        ASSERT_EQ(order.size(), 4u);
+        EXPECT_EQ(order.front(), 0);
+        EXPECT_EQ(order.back(), 3);
+    }
+}
+
+TEST(CompiledGraphTest, CoroutineBodiesAreRecreatedPerRun)
+{
+    WorkStealingThreadPool pool(2);
+    CompiledGraph graph;
+    atomic<int> count{0};
+
+    auto first = graph.addNode([&]() -> Task<void>
+                               {
+        co_await pool.schedule();
+        count.fetch_add(1);
+        co_return; });
+    auto second = graph.addNode([&]
+                                { count.fetch_add(10); });
+    graph.dependsOn(second, first);
+
+    graph.run(pool);
+    graph.run(pool);
+    graph.run(pool);
+
+    EXPECT_EQ(count.load(), 33);
+}
+
+TEST(CompiledGraphTest, CompileRejectsCycle)
+{
+    CompiledGraph graph;
+    auto a = graph.addNode([] {});
+    auto b = graph.addNode([] {});
+    graph.dependsOn(a, b);
+    graph.dependsOn(b, a);
+
+    EXPECT_THROW(graph.compile(), logic_error);
+    EXPECT_FALSE(graph.isCompiled());
+}
+
+TEST(CompiledGraphTest, TopologicalOrderAndFrozenShape)
+{
+    CompiledGraph graph;
+    auto a = graph.addNode([] {});
+    auto b = graph.addNode([] {});
+    auto c = graph.addNode([] {});
+    graph.dependsOn(a, c);
+    graph.dependsOn(b, a);
+
+    graph.compile();
+
+    auto order = graph.topologicalOrder();
+    EXPECT_EQ(vector<CompiledGraph::NodeId>(order.begin(), order.end()),
+              (vector<CompiledGraph::NodeId>{c, a, b}));
+    EXPECT_THROW(graph.addNode([] {}), logic_error);
+    EXPECT_THROW(graph.dependsOn(c, b), logic_error);
+}
+
+TEST(CompiledGraphTest, ExceptionIsRethrownAndGraphStaysUsable)
+{
+    WorkStealingThreadPool pool(2);
+    CompiledGraph graph;
+    atomic<int> runs{0};
+    bool fail = true;
+
+    auto a = graph.addNode([&]
+                           {
+        if (fail)
+            throw runtime_error("node failed"); });
+    auto b = graph.addNode([&]
+                           { runs.fetch_add(1); });
+    graph.dependsOn(b, a);
+
+    EXPECT_THROW(graph.run(pool), runtime_error);
+
+    fail = false;
+    EXPECT_NO_THROW(graph.run(pool));
+    EXPECT_EQ(runs.load(), 2); // Successors still run after a failed dependency
+}
+
+TEST(CompiledGraphTest, CriticalPathRunsHighestRankFirst)
+{
+    WorkStealingThreadPool pool(1);
+    CompiledGraph graph;
+    graph.setScheduling(CompiledGraph::Scheduling::CriticalPath);
+
+    vector<int> order; // One worker: no locking needed
+    auto record = [&](int id)
+    {
+        return [&order, id]
+        { order.push_back(id); };
+    };
+
+    // root -> {leaf, head -> tail}; the chain is the critical path
+    auto root = graph.addNode(record(0));
+    auto leaf = graph.addNode(record(1));
+    auto head = graph.addNode(record(2));
+    auto tail = graph.addNode(record(3));
+    graph.dependsOn(leaf, root);
+    graph.dependsOn(head, root);
+    graph.dependsOn(tail, head);
+
+    graph.run(pool);
+
+    ASSERT_EQ(order.size(), 4u);
+    EXPECT_EQ(order[1], 2); // head before leaf
+    EXPECT_GT(graph.rank(head), graph.rank(leaf));
+
+    // A heavy enough leaf takes over the critical path
+    graph.setCost(leaf, 1e12);
+    order.clear();
+    graph.run(pool);
+
+    EXPECT_EQ(order, (vector<int>{0, 1, 2, 3}));
+    EXPECT_GT(graph.rank(leaf), graph.rank(head));
+    EXPECT_LT(graph.cost(leaf), 1e12); // Replaced by the measured duration
+}
@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+#include "../src/InplaceFunction.hh"
+#include "../src/JobBuilder.hh"
+#include "../src/JobExecutor.hh"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+TEST(InplaceFunctionTest, SmallCapturesAreStoredInline)
+{
+    int a = 1, b = 2, c = 3;
+    auto lambda = [&a, &b, &c, d = 4]()
+    { return a + b + c + d; };
+
+    using Fn = InplaceFunction<int(), 4 * sizeof(void *)>;
+    static_assert(Fn::fitsInline<decltype(lambda)>());
+
+    Fn f = lambda;
+    EXPECT_EQ(f(), 10);
+
+    // Bigger than the buffer: still works, from the heap
+    array<int, 64> big{};
+    big[63] = 5;
+    auto heavy = [big]()
+    { return big[63]; };
+    static_assert(!Fn::fitsInline<decltype(heavy)>());
+
+    Fn g = heavy;
+    EXPECT_EQ(g(), 5);
+}
+
+TEST(InplaceFunctionTest, AcceptsMoveOnlyCallables)
+{
+    auto owned = make_unique<string>("owned");
+    UniqueFunction<size_t()> f = [p = std::move(owned)]()
+    { return p->size(); };
+
+    UniqueFunction<size_t()> moved = std::move(f);
+    EXPECT_FALSE(f);
+    ASSERT_TRUE(moved);
+    EXPECT_EQ(moved(), 5u);
+}
+
+TEST(InplaceFunctionTest, EmptyAndResetBehaveLikeStdFunction)
+{
+    UniqueFunction<void(int)> f;
+    EXPECT_FALSE(f);
+    EXPECT_TRUE(f == nullptr);
+    EXPECT_THROW(f(1), bad_function_call);
+
+    void (*none)(int) = nullptr;
+    f = none;
+    EXPECT_FALSE(f);
+
+    int total = 0;
+    f = [&](int x)
+    { total += x; };
+    f(2);
+    f(3);
+    EXPECT_EQ(total, 5);
+
+    f = nullptr;
+    EXPECT_FALSE(f);
+}
+
+// copy() duplicates copyable callables, inline or on the heap, and refuses move-only ones
+TEST(InplaceFunctionTest, CopiesOnlyCopyableCallables)
+{
+    auto counter = make_shared<int>(0);
+    UniqueFunction<int()> small = [counter]()
+    { return ++*counter; };
+    ASSERT_TRUE(small.copyable());
+
+    UniqueFunction<int()> smallCopy = small.copy();
+    EXPECT_EQ(counter.use_count(), 3);
+    EXPECT_EQ(small(), 1);
+    EXPECT_EQ(smallCopy(), 2);
+
+    array<int, 64> big{};
+    big[0] = 7;
+    UniqueFunction<int()> heavy = [big]() mutable
+    { return ++big[0]; };
+    UniqueFunction<int()> heavyCopy = heavy.copy();
+    EXPECT_EQ(heavy(), 8);
+    EXPECT_EQ(heavyCopy(), 8); // Its own captures
+
+    UniqueFunction<int()> moveOnly = [p = make_unique<int>(1)]()
+    { return *p; };
+    EXPECT_FALSE(moveOnly.copyable());
+    EXPECT_THROW(moveOnly.copy(), logic_error);
+
+    UniqueFunction<int()> empty;
+    EXPECT_TRUE(empty.copyable());
+    EXPECT_FALSE(empty.copy());
+}
+
+// Destroying or overwriting the function destroys the captured state exactly once
+TEST(InplaceFunctionTest, DestroysCapturesOnce)
+{
+    auto counter = make_shared<int>(0);
+    {
+        UniqueFunction<int()> f = [counter]()
+        { return *counter; };
+        UniqueFunction<int()> g = std::move(f);
+        EXPECT_EQ(counter.use_count(), 2);
+
+        g = [] { return 0; };
+        EXPECT_EQ(counter.use_count(), 1);
+
+        g = [counter]()
+        { return *counter; };
+        EXPECT_EQ(counter.use_count(), 2);
+    }
+
+    EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST(InplaceFunctionTest, JobsTakeMoveOnlyTasksAndCallbacks)
+{
+    auto payload = make_unique<int>(41);
+    int seen = 0;
+    bool resultSeen = false;
+
+    Job job = JobBuilder()
+                  .withId("move-only")
+                  .withTask([p = std::move(payload), &seen]()
+                            { seen = *p + 1; })
+                  .onResult([&resultSeen, marker = make_unique<int>(1)](const JobResult &result)
+                            { resultSeen = result.success && *marker == 1; })
+                  .build();
+
+    JobResult result = JobExecutor::execute(job);
+
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(seen, 42);
+    EXPECT_TRUE(resultSeen);
+}
+
+// A timed job shares its move-only task with the attempt thread, and keeps it for retries
+TEST(InplaceFunctionTest, TimedJobRetriesMoveOnlyTask)
+{
+    auto attempts = make_shared<int>(0);
+    Job job;
+    job.timeoutMs = 1000;
+    job.retryCount = 2;
+    job.tasks = [attempts, guard = make_unique<int>(0)]()
+    {
+        if (++*attempts < 3)
+            throw runtime_error("not yet");
+    };
+
+    JobResult result = JobExecutor::execute(job);
+
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(*attempts, 3);
+}
+
+// A copyable timed task gets a fresh copy per attempt: a timeout is retried
+TEST(InplaceFunctionTest, TimedOutCopyableTaskIsRetried)
+{
+    auto started = make_shared<atomic<int>>(0);
+    auto finished = make_shared<atomic<int>>(0);
+    Job job;
+    job.timeoutMs = 20;
+    job.retryCount = 3;
+    job.tasks = [started, finished]()
+    {
+        started->fetch_add(1);
+        this_thread::sleep_for(chrono::milliseconds(200));
+        finished->fetch_add(1);
+    };
+
+    JobResult result = JobExecutor::execute(job);
+
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.attempts, 4);
+    EXPECT_EQ(started->load(), 4);
+
+    // Let the abandoned attempts finish before the test ends
+    while (finished->load() < 4)
+        this_thread::sleep_for(chrono::milliseconds(10));
+}
+
+// A move-only timed task is shared with the abandoned attempt: it is not retried under it
+TEST(InplaceFunctionTest, TimedOutMoveOnlyTaskIsNotRetriedWhileRunning)
+{
+    auto started = make_shared<atomic<int>>(0);
+    auto finished = make_shared<atomic<bool>>(false);
+    Job job;
+    job.timeoutMs = 20;
+    job.retryCount = 3;
+    job.tasks = [started, finished, guard = make_unique<int>(0)]()
+    {
+        started->fetch_add(1);
+        this_thread::sleep_for(chrono::milliseconds(200));
+        finished->store(true);
+    };
+
+    JobResult result = JobExecutor::execute(job);
+
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.attempts, 1);
+    EXPECT_EQ(started->load(), 1);
+
+    // Let the abandoned attempt finish before the test ends
+    while (!finished->load())
+        this_thread::sleep_for(chrono::milliseconds(10));
+}
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include "../src/Job.hh"
+#include "../src/JobBuilder.hh"
+#include "../src/JobExecutor.hh"
 #include "../src/Logger.hh"
 
 TEST(JobTest, RetryAndTimeoutSimulation)
@@ -44,3 +46,54 @@ TEST(JobTest, RetryAndTimeoutSimulation)
     EXPECT_TRUE(completed);
     EXPECT_EQ(attempt, 3);
 }
+
+TEST(JobTest, BareTaskHasNoColdBlock)
+{
+    Job job([] {});
+
+    EXPECT_EQ(job.cold, nullptr);
+    EXPECT_EQ(job.details().id, "");
+    EXPECT_EQ(job.details().category, "default");
+
+    job.editDetails().id = "named";
+    ASSERT_NE(job.cold, nullptr);
+    EXPECT_EQ(job.details().id, "named");
+}
+
+// Jobs stamped from one builder share its strings and callbacks
+TEST(JobTest, BuilderTemplateSharesDetails)
+{
+    atomic<int> results{0};
+    int ran = 0;
+
+    JobBuilder builder;
+    builder.withId("stamped")
+        .withCategory("batch")
+        .withRetry(2)
+        .withNumber(10)
+        .onResult([&](const JobResult &r)
+                  { results += r.success && r.jobId == "stamped" ? 1 : 0; });
+
+    Job first = builder.build([&]
+                              { ran++; });
+    Job second = builder.build([&]
+                               { ran++; });
+
+    EXPECT_EQ(first.cold, second.cold);
+    EXPECT_EQ(first.number, 10u);
+    EXPECT_EQ(second.number, 11u);
+    EXPECT_EQ(second.retryCount, 2);
+    EXPECT_EQ(second.details().category, "batch");
+
+    JobExecutor::execute(first);
+    JobExecutor::execute(second);
+    EXPECT_EQ(ran, 2);
+    EXPECT_EQ(results.load(), 2);
+
+    // Editing a shared block would change every job built from it
+    EXPECT_THROW(first.editDetails(), logic_error);
+    EXPECT_THROW(builder.withId("other"), logic_error);
+
+    builder.reset().withId("other");
+    EXPECT_EQ(first.details().id, "stamped");
+}
@@ -7,7 +7,7 @@
 TEST(JobExecutorTest, SuccessWithoutRetry)
 {
     Job job;
-    job.id = "job_1";
+    job.editDetails().id = "job_1";
     job.tasks = []() { this_thread::sleep_for(chrono::milliseconds(50)); };
     job.timeoutMs = 200;
     job.retryCount = 0;
@@ -21,7 +21,7 @@ TEST(JobExecutorTest, SuccessWithoutRetry)
 TEST(JobExecutorTest, TimeoutAndFail)
 {
     Job job;
-    job.id = "job_2";
+    job.editDetails().id = "job_2";
     job.tasks = []() { this_thread::sleep_for(chrono::milliseconds(200)); };
     job.timeoutMs = 100;
     job.retryCount = 0;
@@ -37,7 +37,7 @@ TEST(JobExecutorTest, RetryUntilSuccess)
 {
     atomic<int> counter{0};
     Job job;
-    job.id = "job_3";
+    job.editDetails().id = "job_3";
     job.retryCount = 3;
     job.timeoutMs = 0;
     job.tasks = [&]() {
@@ -56,10 +56,10 @@ TEST(JobExecutorTest, CallbackTriggered)
     atomic<bool> called{false};
 
     Job job;
-    job.id = "job_4";
+    job.editDetails().id = "job_4";
     job.tasks = []() {};
     job.retryCount = 0;
-    job.onResult = [&](const JobResult &r) {
+    job.editDetails().onResult = [&](const JobResult &r) {
         called = true;
         EXPECT_EQ(r.jobId, "job_4");
     };
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include "../src/JobBuilder.hh"
+#include "../src/JobDispatcher.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Wait until `done` reaches `count`, at most 10s
+static bool waitFor(const atomic<int> &done, int count)
+{
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(10);
+    while (done.load() < count)
+    {
+        if (chrono::steady_clock::now() > deadline)
+            return false;
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    return true;
+}
+
+TEST(JobFeedTest, RangeSourceRunsEveryJob)
+{
+    constexpr int count = 10000;
+    atomic<int> done{0};
+    atomic<long long> sum{0};
+
+    JobDispatcher dispatcher(2);
+    dispatcher.submitFrom(views::iota(0, count) | views::transform([&](int i)
+                                                                   { return JobBuilder::typed().build([&, i]
+                                                                                                      { sum += i; done++; }); }));
+
+    ASSERT_TRUE(waitFor(done, count));
+    dispatcher.stop();
+    EXPECT_EQ(sum.load(), static_cast<long long>(count) * (count - 1) / 2);
+}
+
+// Only the batches in flight exist at any time, however long the source is
+TEST(JobFeedTest, MemoryBoundedByBatchesInFlight)
+{
+    constexpr int threads = 2;
+    constexpr int count = 100000;
+    atomic<int> created{0}, done{0};
+    int maxLive = 0;
+
+    JobDispatcher dispatcher(threads);
+    dispatcher.submitFrom([&]() -> unique_ptr<Job>
+                          {
+        if (created.load() == count)
+            return nullptr;
+
+        // Sources are pulled one thread at a time
+        maxLive = max(maxLive, created.load() - done.load());
+        created++;
+        return JobBuilder::typed().build([&]
+                                         { done++; })
+            .toJob(); });
+
+    ASSERT_TRUE(waitFor(done, count));
+    dispatcher.stop();
+    EXPECT_LE(maxLive, threads * static_cast<int>(JobFeed::batchSize + 1));
+}
+
+TEST(JobFeedTest, TypedJobsAndOptionalSources)
+{
+    atomic<int> done{0};
+    int next = 0;
+
+    JobDispatcher dispatcher(2);
+    auto builder = JobBuilder::typed().onComplete([&](bool success, int, long long)
+                                                  { done += success; });
+    auto task = [] {};
+    dispatcher.submitFrom([&]() -> optional<decltype(builder.build(task))>
+                          {
+        if (next++ == 500)
+            return nullopt;
+        return builder.build(task); });
+
+    vector<unique_ptr<Job>> jobs;
+    for (int i = 0; i < 500; ++i)
+        jobs.push_back(make_unique<Job>([&]
+                                        { done++; }));
+    dispatcher.submitFrom(std::move(jobs));
+
+    ASSERT_TRUE(waitFor(done, 1000));
+    dispatcher.stop();
+}
+
+TEST(JobFeedTest, ThrowingSourceIsDropped)
+{
+    atomic<int> done{0};
+    int produced = 0;
+
+    JobDispatcher dispatcher(1);
+    dispatcher.submitFrom([&]() -> unique_ptr<Job>
+                          {
+        if (produced == 10)
+            throw runtime_error("source failed");
+        produced++;
+        return make_unique<Job>([&]
+                                { done++; }); });
+    dispatcher.submitFrom(views::iota(0, 10) | views::transform([&](int)
+                                                                { return make_unique<Job>([&]
+                                                                                          { done++; }); }));
+
+    ASSERT_TRUE(waitFor(done, 20));
+    dispatcher.stop();
+    EXPECT_EQ(produced, 10);
+
+    // The failure is surfaced: counted, and the exception kept
+    const JobFeed &feed = dispatcher.jobFeed();
+    EXPECT_FALSE(feed.hasWork());
+    EXPECT_EQ(feed.pulledJobs(), 20u);
+    EXPECT_EQ(feed.droppedSources(), 1u);
+    ASSERT_TRUE(feed.error());
+    EXPECT_THROW(rethrow_exception(feed.error()), runtime_error);
+}
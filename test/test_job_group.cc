@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+#include "../src/JobBuilder.hh"
+#include "../src/JobGroup.hh"
+#include "../src/task.hh"
+
+#include <atomic>
+#include <future>
+#include <numeric>
+#include <ranges>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+TEST(JobGroupTest, WaitSummarisesOutcomes)
+{
+    JobDispatcher dispatcher(4);
+    JobGroup group(dispatcher);
+    atomic<int> ran{0};
+
+    for (int i = 0; i < 200; ++i)
+        group.add([&, i]
+                  {
+            ran++;
+            if (i % 10 == 0)
+                throw runtime_error("failed"); });
+    for (int i = 0; i < 50; ++i)
+        group.add(JobBuilder::typed().withRetry(1).build([&]
+                                                         { ran++; }));
+    for (int i = 0; i < 10; ++i)
+        group.add([&, i]
+                  { ran++; return i % 2 == 0; });
+
+    JobGroupSummary summary = group.wait();
+    dispatcher.stop();
+
+    EXPECT_EQ(ran.load(), 260);
+    EXPECT_EQ(group.size(), 260u);
+    EXPECT_EQ(summary.succeeded, 235u);
+    EXPECT_EQ(summary.failed, 25u);
+    EXPECT_EQ(summary.cancelled, 0u);
+    EXPECT_EQ(accumulate(summary.latencyHistogram.begin(), summary.latencyHistogram.end(), size_t(0)), 260u);
+}
+
+// Plain Jobs run through JobExecutor, with its retries
+TEST(JobGroupTest, PlainJobsUseTheExecutor)
+{
+    JobDispatcher dispatcher(2);
+    JobGroup group(dispatcher);
+    int attempts = 0;
+
+    JobBuilder builder;
+    builder.withRetry(2);
+    group.add(make_unique<Job>(builder.build([&]
+                                             {
+        if (++attempts < 3)
+            throw runtime_error("retry me"); })));
+
+    JobGroupSummary summary = group.wait();
+    dispatcher.stop();
+
+    EXPECT_EQ(attempts, 3);
+    EXPECT_EQ(summary.succeeded, 1u);
+}
+
+TEST(JobGroupTest, CancelSkipsJobsNotStarted)
+{
+    JobDispatcher dispatcher(1);
+    JobGroup group(dispatcher);
+    promise<void> release;
+    shared_future<void> released = release.get_future().share();
+    atomic<bool> started{false};
+    atomic<int> ran{0};
+
+    group.add([&]
+              {
+        started = true;
+        released.wait();
+        ran++; });
+    while (!started)
+        this_thread::yield();
+
+    for (int i = 0; i < 20; ++i)
+        group.add([&]
+                  { ran++; });
+
+    group.cancel();
+    release.set_value();
+
+    JobGroupSummary summary = group.wait();
+    dispatcher.stop();
+
+    EXPECT_TRUE(group.cancelled());
+    EXPECT_EQ(ran.load(), 1);
+    EXPECT_EQ(summary.succeeded, 1u);
+    EXPECT_EQ(summary.cancelled, 20u);
+}
+
+// The coroutine resumes on the worker that completes the last job
+TEST(JobGroupTest, CoAwaitResumesWhenDone)
+{
+    JobDispatcher dispatcher(2);
+    atomic<int> ran{0};
+
+    auto body = [&]() -> Task<size_t>
+    {
+        JobGroup group(dispatcher);
+        for (int i = 0; i < 100; ++i)
+            group.add([&]
+                      { ran++; });
+
+        JobGroupSummary summary = co_await group;
+        co_return summary.succeeded;
+    };
+
+    size_t succeeded = body().get();
+    dispatcher.stop();
+
+    EXPECT_EQ(succeeded, 100u);
+    EXPECT_EQ(ran.load(), 100);
+}
+
+// Jobs pulled from a source join the group as the workers pull them
+TEST(JobGroupTest, AddFromPullsLazily)
+{
+    constexpr int count = 1000;
+    JobDispatcher dispatcher(4);
+    JobGroup group(dispatcher);
+    atomic<int> ran{0};
+
+    group.addFrom(views::iota(0, count) | views::transform([&](int i)
+                                                           { return JobBuilder::typed().build([&, i]
+                                                                                              { ran++; return i % 100 != 0; }); }));
+    group.add([&]
+              { ran++; });
+
+    JobGroupSummary summary = group.wait();
+    dispatcher.stop();
+
+    EXPECT_EQ(ran.load(), count + 1);
+    EXPECT_EQ(group.size(), static_cast<size_t>(count + 1));
+    EXPECT_EQ(summary.succeeded, static_cast<size_t>(count + 1));
+}
+
+// A source that throws ends with the jobs it produced; the feed reports it
+TEST(JobGroupTest, ThrowingSourceEndsTheGroup)
+{
+    JobDispatcher dispatcher(2);
+    JobGroup group(dispatcher);
+    int produced = 0;
+
+    group.addFrom([&]() -> unique_ptr<Job>
+                  {
+        if (produced == 10)
+            throw runtime_error("source failed");
+        produced++;
+        auto job = make_unique<Job>([] {});
+        job->spawned = true;
+        return job; });
+
+    JobGroupSummary summary = group.wait();
+    dispatcher.stop();
+
+    EXPECT_EQ(summary.succeeded, 10u);
+    EXPECT_EQ(dispatcher.jobFeed().droppedSources(), 1u);
+}
+
+// A worker settles the completions it deferred before it runs other work
+TEST(JobGroupTest, DeferredCompletionsSettleBeforeOtherWork)
+{
+    JobDispatcher dispatcher(1);
+    JobGroup group(dispatcher);
+    promise<void> queued, groupDone;
+    shared_future<void> allQueued = queued.get_future().share();
+    shared_future<void> finished = groupDone.get_future().share();
+
+    auto spawned = [](auto task)
+    {
+        auto job = make_unique<Job>(std::move(task));
+        job->spawned = true;
+        return job;
+    };
+
+    // Holds the only worker until everything is queued
+    dispatcher.dispatch(spawned([allQueued]
+                                { allQueued.wait(); }));
+
+    // Queues run newest first: the group's jobs, then this one, which blocks until the group is seen done
+    dispatcher.dispatch(spawned([finished]
+                                { finished.wait_for(chrono::seconds(10)); }));
+    for (int i = 0; i < 10; ++i)
+        group.add([] {});
+    queued.set_value();
+
+    auto waiter = async(launch::async, [&]
+                        { return group.wait(); });
+    bool settled = waiter.wait_for(chrono::seconds(5)) == future_status::ready;
+    groupDone.set_value();
+    dispatcher.stop();
+
+    ASSERT_TRUE(settled);
+    EXPECT_EQ(waiter.get().succeeded, 10u);
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include "../src/JobDispatcher.hh"
+#include "../src/JobPool.hh"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+TEST(JobPoolTest, ReleasedJobIsReusedOnSameThread)
+{
+    auto first = make_unique<Job>();
+    Job *storage = first.get();
+    first.reset();
+
+    auto second = make_unique<Job>();
+    EXPECT_EQ(second.get(), storage);
+}
+
+// Jobs released on another thread come back through the shared list
+TEST(JobPoolTest, JobsReleasedElsewhereAreReused)
+{
+    constexpr size_t count = 4 * JobPool::batchSize;
+
+    vector<unique_ptr<Job>> jobs;
+    for (size_t i = 0; i < count; ++i)
+        jobs.push_back(make_unique<Job>());
+
+    thread releaser([&]
+                    { jobs.clear(); });
+    releaser.join();
+
+    // The releasing thread has exited: everything it released is on the shared list
+    JobPool::Stats before = JobPool::stats();
+    EXPECT_GE(before.sharedBlocks, count);
+
+    for (size_t i = 0; i < count; ++i)
+        jobs.push_back(make_unique<Job>());
+
+    EXPECT_EQ(JobPool::stats().blocks, before.blocks);
+}
+
+// Dispatching round after round settles on a fixed set of slabs
+TEST(JobPoolTest, SteadyStateDispatchDoesNotGrow)
+{
+    constexpr int threads = 2;
+    constexpr int jobsPerRound = 1000;
+    constexpr int rounds = 20;
+
+    JobDispatcher dispatcher(threads);
+    atomic<int> done{0};
+    size_t blocksBefore = JobPool::stats().blocks;
+
+    for (int round = 1; round <= rounds; ++round)
+    {
+        for (int i = 0; i < jobsPerRound; ++i)
+        {
+            auto job = make_unique<Job>([&done]
+                                        { done++; });
+            job->spawned = true; // Run the bare task, without executor logging
+            dispatcher.dispatch(i % threads, std::move(job));
+        }
+
+        while (done.load() < round * jobsPerRound)
+            this_thread::yield();
+    }
+
+    dispatcher.stop();
+
+    // In flight at most one round, plus what the workers keep on their own lists,
+    // rounded up to whole slabs
+    JobPool::Stats stats = JobPool::stats();
+    size_t slabBlocks = stats.blocks / stats.slabs;
+    size_t bound = jobsPerRound + threads * 2 * JobPool::batchSize + 2 * slabBlocks;
+    EXPECT_LE(stats.blocks - blocksBefore, bound);
+}
+
+TEST(JobPoolTest, HugePageSlabsServeJobs)
+{
+    JobPool::useHugePages(true);
+
+    // More than any earlier slab can hold, so a new one is carved
+    size_t count = JobPool::stats().blocks + 1;
+    vector<unique_ptr<Job>> jobs;
+    for (size_t i = 0; i < count; ++i)
+    {
+        jobs.push_back(make_unique<Job>([]() {}));
+        jobs.back()->number = i;
+    }
+
+    JobPool::useHugePages(false);
+
+#ifdef __linux__
+    EXPECT_GT(JobPool::stats().hugePageSlabs, 0u);
+#endif
+    EXPECT_EQ(jobs.back()->number, count - 1);
+}
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include "../src/JobResult.hh"
+
+#include <array>
+#include <vector>
+
+using namespace std;
+
+static JobResult sampleResult(const string &id, bool success)
+{
+    JobResult r;
+    r.success = success;
+    r.attempts = 2;
+    r.durationMs = 1234;
+    r.jobId = id;
+    r.category = CategoryName("writer");
+    r.startTime = system_clock::time_point(seconds(1700000000));
+    r.endTime = r.startTime + milliseconds(1234);
+    if (!success)
+        r.errorMessage = "disk \"full\"\n\tat\\path\x01";
+    return r;
+}
+
+TEST(JobResultWriterTest, JSONMatchesToJSONAndEscapes)
+{
+    JobResult ok = sampleResult("plain", true);
+    EXPECT_EQ(ok.toJSON(), "{\"jobId\": \"plain\", \"category\": \"writer\", \"success\": true, "
+                           "\"attempts\": 2, \"durationMs\": 1234, \"timestamp\": \"1700000001\"}");
+
+    JobResult failed = sampleResult("quote\"d", false);
+    string json = failed.toJSON();
+    EXPECT_NE(json.find("\"jobId\": \"quote\\\"d\""), string::npos);
+    EXPECT_NE(json.find("\"error\": \"disk \\\"full\\\"\\n\\tat\\\\path\\u0001\""), string::npos);
+
+    array<char, 512> buffer;
+    JobResultWriter writer(buffer);
+    ASSERT_TRUE(writer.appendJSON(failed));
+    EXPECT_EQ(writer.view(), json);
+}
+
+// A batch stops at the first result that does not fit, leaving only whole lines
+TEST(JobResultWriterTest, FullBufferKeepsWholeRecords)
+{
+    vector<JobResult> results;
+    for (int i = 0; i < 10; ++i)
+        results.push_back(sampleResult("job-" + to_string(i), i % 3 != 0));
+
+    size_t lineSize = results[1].toJSON().size() + 1;
+    vector<char> buffer(lineSize * 3 + lineSize / 2);
+    JobResultWriter writer(buffer);
+
+    size_t written = writer.appendJSONLines(results);
+    ASSERT_GT(written, 0u);
+    ASSERT_LT(written, results.size());
+
+    string expected;
+    for (size_t i = 0; i < written; ++i)
+        expected += results[i].toJSON() + "\n";
+    EXPECT_EQ(writer.view(), expected);
+
+    // Drain and carry on where the batch stopped
+    writer.clear();
+    EXPECT_EQ(writer.appendJSONLines(span(results).subspan(written, 1)), 1u);
+    EXPECT_EQ(writer.view(), results[written].toJSON() + "\n");
+}
+
+TEST(JobResultWriterTest, BinaryRoundTrip)
+{
+    vector<JobResult> results = {sampleResult("first", true), sampleResult("second", false), JobResult()};
+
+    array<char, 1024> buffer;
+    JobResultWriter writer(buffer);
+    ASSERT_EQ(writer.appendBinary(results), results.size());
+    EXPECT_LT(writer.size(), results[1].toJSON().size() * 2);
+
+    span<const char> in(writer.view().data(), writer.size());
+    for (const JobResult &expected : results)
+    {
+        JobResult decoded;
+        size_t consumed = JobResultWriter::readBinary(in, decoded);
+        ASSERT_GT(consumed, 0u);
+        in = in.subspan(consumed);
+
+        EXPECT_EQ(decoded.success, expected.success);
+        EXPECT_EQ(decoded.attempts, expected.attempts);
+        EXPECT_EQ(decoded.durationMs, expected.durationMs);
+        EXPECT_EQ(decoded.jobId, expected.jobId);
+        EXPECT_EQ(decoded.category, expected.category);
+        EXPECT_EQ(decoded.errorMessage, expected.errorMessage);
+        EXPECT_EQ(decoded.startTime, expected.startTime);
+        EXPECT_EQ(decoded.endTime, expected.endTime);
+    }
+
+    EXPECT_TRUE(in.empty());
+
+    // A truncated record is not decoded
+    JobResult partial;
+    EXPECT_EQ(JobResultWriter::readBinary(span<const char>(buffer.data(), 5), partial), 0u);
+}
+
+// Categories read back are looked up, never interned: untrusted input cannot fill the table
+TEST(JobResultWriterTest, UnknownCategoryIsNotInterned)
+{
+    auto record = [](const string &category)
+    {
+        string body;
+        body += '\x01';           // flags: success
+        body += string(4, '\0'); // attempts, durationMs, startTime, endTime
+        body += '\x02';
+        body += "id";
+        body += static_cast<char>(category.size());
+        body += category;
+        return static_cast<char>(body.size()) + body;
+    };
+
+    size_t namesBefore = CategoryName::table().size();
+    string unknown;
+    JobResult decoded;
+
+    for (int i = 0; i < 100; ++i)
+    {
+        string bytes = record("probe-" + to_string(i));
+        ASSERT_EQ(JobResultWriter::readBinary(bytes, decoded, &unknown), bytes.size());
+        EXPECT_EQ(decoded.category, CategoryName());
+        EXPECT_EQ(unknown, "probe-" + to_string(i));
+    }
+
+    EXPECT_EQ(CategoryName::table().size(), namesBefore);
+
+    // A category this process knows keeps its slot
+    CategoryName known("writer-known");
+    string bytes = record("writer-known");
+    ASSERT_EQ(JobResultWriter::readBinary(bytes, decoded, &unknown), bytes.size());
+    EXPECT_EQ(decoded.category, known);
+    EXPECT_TRUE(unknown.empty());
+}
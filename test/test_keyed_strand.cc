@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include "../src/JobBuilder.hh"
+#include "../src/JobDispatcher.hh"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Wait until `done` reaches `count`, at most 10s
+static bool waitFor(const atomic<int> &done, int count)
+{
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(10);
+    while (done.load() < count)
+    {
+        if (chrono::steady_clock::now() > deadline)
+            return false;
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// Per key: FIFO and never two jobs at once, with producers on several threads
+TEST(KeyedStrandTest, SameKeyRunsInOrderOneAtATime)
+{
+    constexpr int keys = 8, producers = 4, perProducer = 500;
+    constexpr int total = keys * producers * perProducer;
+
+    struct PerKey
+    {
+        atomic<int> running{0};
+        atomic<bool> overlapped{false};
+        vector<int> lastSeen = vector<int>(producers, -1);
+        atomic<bool> outOfOrder{false};
+    };
+    vector<PerKey> state(keys);
+    atomic<int> done{0};
+
+    JobDispatcher dispatcher(4);
+    vector<thread> threads;
+    for (int p = 0; p < producers; ++p)
+        threads.emplace_back([&, p]
+                             {
+            for (int i = 0; i < perProducer; ++i)
+                for (int k = 0; k < keys; ++k)
+                    dispatcher.dispatchKeyed(k, JobBuilder::typed().build([&, p, i, k]
+                                                                          {
+                        PerKey &s = state[k];
+                        if (s.running.fetch_add(1) != 0)
+                            s.overlapped = true;
+
+                        // Unsynchronised on purpose: the strand serialises the key
+                        if (s.lastSeen[p] != i - 1)
+                            s.outOfOrder = true;
+                        s.lastSeen[p] = i;
+
+                        s.running.fetch_sub(1);
+                        done++; })); });
+    for (thread &t : threads)
+        t.join();
+
+    ASSERT_TRUE(waitFor(done, total));
+    dispatcher.stop();
+
+    for (PerKey &s : state)
+    {
+        EXPECT_FALSE(s.overlapped.load());
+        EXPECT_FALSE(s.outOfOrder.load());
+    }
+}
+
+// One hot key does not pin the others to its worker
+TEST(KeyedStrandTest, DifferentKeysRunInParallel)
+{
+    constexpr int keys = 4;
+    atomic<int> running{0}, maxRunning{0}, done{0};
+
+    JobDispatcher dispatcher(keys);
+    for (int k = 0; k < keys; ++k)
+        dispatcher.dispatchKeyed(string("account-") + to_string(k), JobBuilder::typed().build([&]
+                                                                                             {
+            int now = running.fetch_add(1) + 1;
+            int seen = maxRunning.load();
+            while (now > seen && !maxRunning.compare_exchange_weak(seen, now))
+            {
+            }
+            this_thread::sleep_for(chrono::milliseconds(50));
+            running.fetch_sub(1);
+            done++; }));
+
+    ASSERT_TRUE(waitFor(done, keys));
+    dispatcher.stop();
+    EXPECT_GT(maxRunning.load(), 1);
+}
+
+// Distinct keys sharing a strand are serialised together, yet each of them runs to the end
+TEST(KeyedStrandTest, CollidingKeysStillMakeProgress)
+{
+    constexpr int keys = 4, perKey = 200;
+    atomic<int> running{0}, done{0};
+    atomic<bool> overlapped{false};
+    vector<atomic<int>> ran(keys);
+
+    JobDispatcher dispatcher(4, 1); // A single strand: every key collides
+    ASSERT_EQ(dispatcher.strandCount(), 1u);
+
+    for (int i = 0; i < perKey; ++i)
+        for (int k = 0; k < keys; ++k)
+            dispatcher.dispatchKeyed(string("key-") + to_string(k), JobBuilder::typed().build([&, k]
+                                                                                          {
+                if (running.fetch_add(1) != 0)
+                    overlapped = true;
+                ran[k]++;
+                running.fetch_sub(1);
+                done++; }));
+
+    ASSERT_TRUE(waitFor(done, keys * perKey));
+    dispatcher.stop();
+
+    EXPECT_FALSE(overlapped.load());
+    for (int k = 0; k < keys; ++k)
+        EXPECT_EQ(ran[k].load(), perKey);
+}
+
+// Without a count the strand table grows with the workers
+TEST(KeyedStrandTest, StrandTableSizedFromWorkers)
+{
+    JobDispatcher small(2);
+    EXPECT_EQ(small.strandCount(), 1024u);
+    small.stop();
+
+    JobDispatcher wide(64);
+    EXPECT_EQ(wide.strandCount(), 4096u);
+    wide.stop();
+
+    JobDispatcher requested(2, 3000);
+    EXPECT_EQ(requested.strandCount(), 4096u);
+    requested.stop();
+}
+
+// Jobs still queued on a strand at stop() are released with the dispatcher
+TEST(KeyedStrandTest, PendingJobsReleasedOnDestruction)
+{
+    auto alive = make_shared<int>(0);
+    {
+        JobDispatcher dispatcher(1);
+        atomic<bool> started{false};
+
+        // Keeps the only worker busy until stop(), so the strand never drains
+        dispatcher.dispatch(0, JobBuilder::typed().build([&]
+                                                         {
+            started = true;
+            this_thread::sleep_for(chrono::milliseconds(50)); }));
+        while (!started)
+            this_thread::yield();
+
+        for (int i = 0; i < 10; ++i)
+            dispatcher.dispatchKeyed(1, JobBuilder::typed().build([alive] {}));
+        dispatcher.stop();
+        EXPECT_GT(alive.use_count(), 1);
+    }
+
+    EXPECT_EQ(alive.use_count(), 1);
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "../src/JobBuilder.hh"
+#include "../src/JobExecutor.hh"
+#include "../src/NameRegistry.hh"
+#include "../src/ProgressTracker.hh"
+
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+TEST(NameRegistryTest, SameNameSameSlot)
+{
+    CategoryName io("registry-io");
+    CategoryName cpu("registry-cpu");
+
+    EXPECT_EQ(CategoryName("registry-io"), io);
+    EXPECT_NE(io, cpu);
+    EXPECT_EQ(io.str(), "registry-io");
+    EXPECT_EQ(CategoryName::fromSlot(cpu.slot()), "registry-cpu");
+
+    // Slot 0 is the default name of each table
+    EXPECT_EQ(CategoryName().slot(), 0u);
+    EXPECT_EQ(CategoryName(), "default");
+}
+
+// Names interned from many threads at once still get one slot each
+TEST(NameRegistryTest, ConcurrentInterning)
+{
+    constexpr int threads = 4;
+    constexpr int names = 500;
+    vector<vector<uint32_t>> slots(threads, vector<uint32_t>(names));
+
+    vector<thread> pool;
+    for (int t = 0; t < threads; ++t)
+        pool.emplace_back([&, t]
+                          {
+            for (int i = 0; i < names; ++i)
+                slots[t][i] = CategoryName("concurrent-" + to_string(i)).slot(); });
+
+    for (auto &th : pool)
+        th.join();
+
+    set<uint32_t> distinct(slots[0].begin(), slots[0].end());
+    EXPECT_EQ(distinct.size(), static_cast<size_t>(names));
+    for (int t = 1; t < threads; ++t)
+        EXPECT_EQ(slots[t], slots[0]);
+
+    for (int i = 0; i < names; ++i)
+        EXPECT_EQ(CategoryName::fromSlot(slots[0][i]).str(), "concurrent-" + to_string(i));
+}
+
+// The executor passes category slots through; names come back only on export
+TEST(NameRegistryTest, ResultsAndTrackerUseSlots)
+{
+    Job job = JobBuilder().withId("interned-job").withCategory("registry-export").withTask([] {}).build();
+    JobResult result = JobExecutor::execute(job);
+
+    EXPECT_EQ(result.jobId, job.details().id);
+    EXPECT_EQ(result.category, CategoryName("registry-export"));
+    EXPECT_NE(result.toJSON().find("\"category\": \"registry-export\""), string::npos);
+
+    ProgressTracker tracker(3);
+    tracker.markJobDoneWithCategory(result.category, 10, LogLevel::Info);
+    tracker.markJobDoneWithCategory(result.category, 30, LogLevel::Warn);
+    tracker.markJobDoneWithCategory("registry-other", 20, LogLevel::Info);
+
+    string exported = tracker.exportJSON();
+    EXPECT_NE(exported.find("\"registry-export\""), string::npos);
+    EXPECT_NE(exported.find("\"registry-other\""), string::npos);
+    EXPECT_NE(exported.find("\"job_count\": 2"), string::npos);
+
+    // Categories interned by others but never reported here are left out
+    EXPECT_EQ(exported.find("\"registry-io\""), string::npos);
+
+    json levels = tracker.exportLevelSummaryJSON();
+    EXPECT_EQ(levels["registry-export"]["INFO"], 1);
+    EXPECT_EQ(levels["registry-export"]["WARN"], 1);
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+
+#include "../src/parallel_algorithms.hh"
+
+#include <atomic>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static vector<int> randomInts(size_t n, int maxValue, unsigned seed)
+{
+    vector<int> values(n);
+    mt19937 rng(seed);
+    uniform_int_distribution<int> dist(0, maxValue);
+    for (int &v : values)
+        v = dist(rng);
+    return values;
+}
+
+TEST(ParallelAlgorithmsTest, ParallelForVisitsEveryIndexOnce)
+{
+    WorkStealingThreadPool pool(4);
+    vector<atomic<int>> visits(100000);
+
+    parallel_for(pool, 0, visits.size(), [&](size_t i)
+                 { visits[i]++; });
+
+    for (auto &v : visits)
+        ASSERT_EQ(v.load(), 1);
+}
+
+TEST(ParallelAlgorithmsTest, ParallelForHonoursOffsetAndGrain)
+{
+    WorkStealingThreadPool pool(3);
+    vector<int> values(1000, 0);
+
+    parallel_for(pool, 100, 900, [&](size_t i)
+                 { values[i] = static_cast<int>(i); }, 1);
+
+    for (size_t i = 0; i < values.size(); ++i)
+        EXPECT_EQ(values[i], (i >= 100 && i < 900) ? static_cast<int>(i) : 0);
+}
+
+TEST(ParallelAlgorithmsTest, ReduceMatchesAccumulate)
+{
+    WorkStealingThreadPool pool(4);
+    vector<int> values = randomInts(250000, 1000, 1);
+
+    long long expected = accumulate(values.begin(), values.end(), 5LL);
+    EXPECT_EQ(parallel_reduce(pool, values.begin(), values.end(), 5LL), expected);
+
+    vector<int> empty;
+    EXPECT_EQ(parallel_reduce(pool, empty.begin(), empty.end(), 7), 7);
+}
+
+// Concatenation is associative but not commutative: partials must be combined in order
+TEST(ParallelAlgorithmsTest, ReduceKeepsOrderForNonCommutativeOp)
+{
+    WorkStealingThreadPool pool(4);
+    string text;
+    for (int i = 0; i < 5000; ++i)
+        text += static_cast<char>('a' + i % 26);
+
+    vector<string> pieces;
+    for (char c : text)
+        pieces.emplace_back(1, c);
+
+    string joined = parallel_reduce(pool, pieces.begin(), pieces.end(), string(), plus<>(), 16);
+    EXPECT_EQ(joined, text);
+}
+
+TEST(ParallelAlgorithmsTest, TransformMatchesSerial)
+{
+    WorkStealingThreadPool pool(4);
+    vector<int> values = randomInts(100000, 1000, 2);
+    vector<long long> squares(values.size());
+
+    auto end = parallel_transform(pool, values.begin(), values.end(), squares.begin(), [](int v)
+                                  { return static_cast<long long>(v) * v; });
+
+    EXPECT_EQ(end, squares.end());
+    for (size_t i = 0; i < values.size(); ++i)
+        ASSERT_EQ(squares[i], static_cast<long long>(values[i]) * values[i]);
+}
+
+TEST(ParallelAlgorithmsTest, InclusiveScanMatchesSerial)
+{
+    WorkStealingThreadPool pool(4);
+
+    for (size_t n : {0u, 1u, 7u, 33u, 100003u})
+    {
+        vector<int> values = randomInts(n, 100, static_cast<unsigned>(n));
+        vector<long long> expected(n), actual(n);
+        inclusive_scan(values.begin(), values.end(), expected.begin(), plus<long long>());
+
+        parallel_inclusive_scan(pool, values.begin(), values.end(), actual.begin(), plus<long long>());
+        EXPECT_EQ(actual, expected) << "n = " << n;
+
+        // In place
+        vector<int> inPlace = values;
+        parallel_inclusive_scan(pool, inPlace.begin(), inPlace.end(), inPlace.begin());
+        for (size_t i = 0; i < n; ++i)
+            ASSERT_EQ(inPlace[i], expected[i]);
+    }
+}
+
+TEST(ParallelAlgorithmsTest, SortHandlesDuplicatesAndComparators)
+{
+    WorkStealingThreadPool pool(4);
+
+    vector<int> fewKeys = randomInts(300000, 10, 3);
+    vector<int> expected = fewKeys;
+    sort(expected.begin(), expected.end());
+    parallel_sort(pool, fewKeys.begin(), fewKeys.end());
+    EXPECT_EQ(fewKeys, expected);
+
+    vector<int> descending = randomInts(200000, 1 << 30, 4);
+    expected = descending;
+    sort(expected.begin(), expected.end(), greater<>());
+    parallel_sort(pool, descending.begin(), descending.end(), greater<>());
+    EXPECT_EQ(descending, expected);
+
+    vector<int> sorted(100000);
+    iota(sorted.begin(), sorted.end(), 0);
+    expected = sorted;
+    parallel_sort(pool, sorted.begin(), sorted.end());
+    EXPECT_EQ(sorted, expected);
+}
+
+TEST(ParallelAlgorithmsTest, BodyExceptionIsRethrown)
+{
+    WorkStealingThreadPool pool(4);
+    atomic<int> ran{0};
+
+    EXPECT_THROW(parallel_for(pool, 0, 10000, [&](size_t i)
+                              {
+        ran++;
+        if (i == 5000)
+            throw runtime_error("bad index"); }, 10),
+                 runtime_error);
+
+    EXPECT_LE(ran.load(), 10000);
+}
+
+// Inner loops run on the same workers; the single worker must not deadlock
+TEST(ParallelAlgorithmsTest, NestedLoopsOnOneWorker)
+{
+    WorkStealingThreadPool pool(1);
+    vector<atomic<int>> cells(64 * 64);
+
+    parallel_for(pool, 0, 64, [&](size_t row)
+                 { parallel_for(pool, 0, 64, [&](size_t col)
+                                { cells[row * 64 + col]++; }, 4); }, 4);
+
+    for (auto &c : cells)
+        ASSERT_EQ(c.load(), 1);
+}
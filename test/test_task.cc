@@ -0,0 +1,287 @@
+#include <gtest/gtest.h>
+
+#include "../src/WorkStealing.hh"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+using namespace std;
+
+static Task<int> valueAfter(int value, int delayMs)
+{
+    co_await sleepAsync(chrono::milliseconds(delayMs));
+    co_return value;
+}
+
+static Task<void> failAfter(int delayMs)
+{
+    co_await sleepAsync(chrono::milliseconds(delayMs));
+    throw runtime_error("boom");
+}
+
+TEST(TaskTest, LazyUntilAwaited)
+{
+    bool started = false;
+    // The lambda must outlive the lazy coroutine it creates
+    auto body = [&]() -> Task<int>
+    {
+        started = true;
+        co_return 7;
+    };
+
+    auto task = body();
+
+    EXPECT_FALSE(started);
+    EXPECT_EQ(task.get(), 7);
+    EXPECT_TRUE(started);
+
+    // Waiting again on a finished task must not resume it
+    task.wait();
+    EXPECT_EQ(task.get(), 7);
+}
+
+TEST(TaskTest, WhenAllVariadicReturnsEveryResult)
+{
+    auto parent = []() -> Task<int>
+    {
+        auto [a, b, c] = co_await when_all(valueAfter(1, 30), valueAfter(2, 10), sleepAsync(chrono::milliseconds(20)));
+        (void)c;
+        co_return a * 10 + b;
+    }();
+
+    EXPECT_EQ(parent.get(), 12);
+}
+
+TEST(TaskTest, WhenAllWithNoTasksCompletesImmediately)
+{
+    auto parent = []() -> Task<int>
+    {
+        auto none = co_await when_all();
+        co_return static_cast<int>(tuple_size_v<decltype(none)>);
+    }();
+
+    EXPECT_EQ(parent.get(), 0);
+}
+
+TEST(TaskTest, WhenAllVectorRunsConcurrently)
+{
+    auto parent = []() -> Task<vector<int>>
+    {
+        vector<Task<int>> tasks;
+        for (int i = 0; i < 8; ++i)
+            tasks.push_back(valueAfter(i, 100));
+
+        co_return co_await when_all(std::move(tasks));
+    }();
+
+    auto start = chrono::steady_clock::now();
+    vector<int> results = parent.get();
+    auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+
+    ASSERT_EQ(results.size(), 8u);
+    for (int i = 0; i < 8; ++i)
+        EXPECT_EQ(results[i], i);
+
+    // Sequential awaiting would take ~800ms
+    EXPECT_LT(elapsed, 500);
+}
+
+TEST(TaskTest, WhenAllRethrowsChildException)
+{
+    auto parent = []() -> Task<void>
+    {
+        vector<Task<void>> tasks;
+        tasks.push_back(sleepAsync(chrono::milliseconds(10)));
+        tasks.push_back(failAfter(5));
+        co_await when_all(std::move(tasks));
+    }();
+
+    EXPECT_THROW(parent.get(), runtime_error);
+}
+
+TEST(TaskTest, WhenAnyReturnsFirstToFinish)
+{
+    auto parent = []() -> Task<WhenAnyResult<int>>
+    {
+        co_return co_await when_any(valueAfter(1, 200), valueAfter(2, 10), valueAfter(3, 100));
+    }();
+
+    auto result = parent.get();
+    EXPECT_EQ(result.index, 1u);
+    EXPECT_EQ(result.value, 2);
+
+    // Let the losers finish before the test exits
+    this_thread::sleep_for(chrono::milliseconds(250));
+}
+
+// A moved-from Task has no coroutine to wait on: rejected before any child starts
+TEST(TaskTest, CombinatorsRejectEmptyTasks)
+{
+    auto emptied = [](Task<int> &&task)
+    {
+        Task<int> owner = std::move(task);
+        return std::move(task);
+    };
+
+    EXPECT_THROW((void)when_all(valueAfter(1, 0), emptied(valueAfter(2, 0))), invalid_argument);
+    EXPECT_THROW((void)when_any(valueAfter(1, 0), emptied(valueAfter(2, 0))), invalid_argument);
+
+    vector<Task<int>> tasks;
+    tasks.push_back(valueAfter(1, 0));
+    tasks.push_back(emptied(valueAfter(2, 0)));
+    EXPECT_THROW((void)when_all(std::move(tasks)), invalid_argument);
+
+    tasks.clear();
+    tasks.push_back(emptied(valueAfter(1, 0)));
+    EXPECT_THROW((void)when_any(std::move(tasks)), invalid_argument);
+}
+
+TEST(TaskTest, WhenAllOnPoolRunsInParallel)
+{
+    WorkStealingThreadPool pool(4);
+    atomic<int> onPool{0};
+
+    auto child = [&](int id) -> Task<int>
+    {
+        co_await pool.schedule();
+        onPool++;
+        this_thread::sleep_for(chrono::milliseconds(50));
+        co_return id;
+    };
+
+    auto body = [&]() -> Task<int>
+    {
+        vector<Task<int>> tasks;
+        for (int i = 1; i <= 4; ++i)
+            tasks.push_back(child(i));
+
+        int sum = 0;
+        for (int v : co_await when_all(std::move(tasks)))
+            sum += v;
+
+        co_return sum;
+    };
+
+    auto parent = body();
+    EXPECT_EQ(parent.get(), 10);
+    EXPECT_EQ(onPool.load(), 4);
+}
+
+TEST(TaskTest, PoolOwnsEnqueuedTasks)
+{
+    WorkStealingThreadPool pool(2);
+    atomic<int> counter{0};
+
+    for (int i = 0; i < 100; ++i)
+        pool.enqueue(wrapAsTask([&]
+                                { counter++; }));
+
+    pool.waitAll();
+    EXPECT_EQ(counter.load(), 100);
+}
+
+// A single worker waiting on a task queued behind it must run it, not block
+TEST(TaskTest, NestedWaitOnWorkerRunsQueuedWork)
+{
+    WorkStealingThreadPool pool(1);
+    atomic<int> result{0};
+
+    auto inner = [&]() -> Task<int>
+    {
+        co_await pool.schedule(); // Lands in the waiting worker's own queue
+        co_return 41;
+    };
+
+    pool.enqueue(wrapAsTask([&]
+                            {
+        auto task = inner();
+        result = task.get() + 1; }));
+
+    pool.waitAll();
+    EXPECT_EQ(result.load(), 42);
+}
+
+TEST(TaskTest, RecursiveWaitsUseEveryWorker)
+{
+    WorkStealingThreadPool pool(2);
+
+    // Each level waits on two children that are scheduled back onto the pool
+    struct Tree
+    {
+        WorkStealingThreadPool &pool;
+
+        Task<int> count(int depth)
+        {
+            co_await pool.schedule();
+            if (depth == 0)
+                co_return 1;
+
+            auto left = count(depth - 1);
+            auto right = count(depth - 1);
+            co_return left.get() + right.get();
+        }
+    };
+
+    Tree tree{pool};
+    auto root = tree.count(8);
+    EXPECT_EQ(root.get(), 256);
+}
+
+TEST(TaskTest, NestedCombinatorsDoNotGrowTheStack)
+{
+    WorkStealingThreadPool pool(2);
+
+    // Each level finishes from its child's completion: resuming the parent
+    // inline there would nest a few stack frames per level
+    struct Chain
+    {
+        WorkStealingThreadPool &pool;
+
+        Task<int> depth(int levels)
+        {
+            co_await pool.schedule();
+            if (levels == 0)
+                co_return 0;
+
+            if (levels % 2)
+            {
+                auto [below] = co_await when_all(depth(levels - 1));
+                co_return below + 1;
+            }
+
+            auto first = co_await when_any(depth(levels - 1));
+            co_return first.value + 1;
+        }
+    };
+
+    Chain chain{pool};
+    auto root = chain.depth(100000);
+    EXPECT_EQ(root.get(), 100000);
+}
+
+TEST(TaskTest, ExecuteWaitsForDependenciesOnWorker)
+{
+    WorkStealingThreadPool pool(1);
+    vector<int> order;
+
+    auto step = [&](int id) -> Task<void>
+    {
+        co_await pool.schedule();
+        order.push_back(id);
+    };
+
+    auto first = step(1);
+    auto second = step(2);
+    auto last = step(3);
+    last.dependsOn(first);
+    last.dependsOn(second);
+
+    pool.enqueue(wrapAsTask([&]
+                            { last.execute(); }));
+    pool.waitAll();
+    last.wait();
+
+    ASSERT_EQ(order.size(), 3u);
+    EXPECT_EQ(order.back(), 3);
+}
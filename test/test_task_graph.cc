@@ -0,0 +1,686 @@
+#include <gtest/gtest.h>
+
+#include "../src/adaptive_task_graph.hh"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Records the order in which graph nodes run
+struct RunLog
+{
+    mutex mtx;
+    vector<int> order;
+
+    void add(int id)
+    {
+        lock_guard<mutex> lock(mtx);
+        order.push_back(id);
+    }
+
+    size_t positionOf(int id)
+    {
+        return find(order.begin(), order.end(), id) - order.begin();
+    }
+};
+
+static Task<void> logNode(RunLog &log, int id)
+{
+    log.add(id);
+    co_return;
+}
+
+TEST(TaskGraphTest, RunsDependenciesFirst)
+{
+    RunLog log;
+    TaskGraph graph(4);
+
+    // Diamond: 1 -> {2, 3} -> 4
+    auto a = make_shared<Task<void>>(logNode(log, 1));
+    auto b = make_shared<Task<void>>(logNode(log, 2));
+    auto c = make_shared<Task<void>>(logNode(log, 3));
+    auto d = make_shared<Task<void>>(logNode(log, 4));
+    b->dependsOn(*a);
+    c->dependsOn(*a);
+    d->dependsOn(*b);
+    d->dependsOn(*c);
+
+    // Added in reverse on purpose: insertion order must not matter
+    graph.addTask(d);
+    graph.addTask(c);
+    graph.addTask(b);
+    graph.addTask(a);
+
+    graph.execute();
+
+    ASSERT_EQ(log.order.size(), 4u);
+    EXPECT_EQ(log.order.front(), 1);
+    EXPECT_EQ(log.order.back(), 4);
+}
+
+TEST(TaskGraphTest, SuspendedDependencyDoesNotBlockWorkers)
+{
+    RunLog log;
+    AdaptiveTaskGraph graph;
+
+    auto slow = make_shared<Task<void>>(wrapAsTask([&]() -> Task<void>
+                                                   {
+        co_await sleepAsync(chrono::milliseconds(50));
+        log.add(1); }));
+
+    auto after = make_shared<Task<void>>(logNode(log, 2));
+    after->dependsOn(*slow);
+
+    graph.addTask(after);
+    graph.addTask(slow);
+
+    // Single worker: an implementation blocking in dep->wait() would deadlock here
+    WorkStealingThreadPool pool(1);
+    graph.TaskGraph::execute(pool);
+
+    EXPECT_EQ(log.order, (vector<int>{1, 2}));
+}
+
+TEST(TaskGraphTest, NodeAwaitedByAnotherNodeStillGatesDependents)
+{
+    RunLog log;
+    TaskGraph graph(2);
+
+    auto slow = make_shared<Task<void>>(wrapAsTask([&]() -> Task<void>
+                                                   {
+        co_await sleepAsync(chrono::milliseconds(50));
+        log.add(1); }));
+
+    // Added first so its body claims slow's waiter slot before the graph does
+    auto awaiter = make_shared<Task<void>>(wrapAsTask([&, slow]() -> Task<void>
+                                                      {
+        Task<void> &dependency = *slow;
+        co_await dependency;
+        log.add(2); }));
+
+    auto after = make_shared<Task<void>>(logNode(log, 3));
+    after->dependsOn(*slow);
+
+    graph.addTask(awaiter);
+    graph.addTask(slow);
+    graph.addTask(after);
+    graph.execute();
+
+    ASSERT_EQ(log.order.size(), 3u);
+    EXPECT_LT(log.positionOf(1), log.positionOf(2));
+    EXPECT_LT(log.positionOf(1), log.positionOf(3));
+}
+
+TEST(TaskGraphTest, LongChainRunsInOrder)
+{
+    RunLog log;
+    TaskGraph graph(2);
+    shared_ptr<Task<void>> prev;
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        auto task = make_shared<Task<void>>(logNode(log, i));
+        if (prev)
+            task->dependsOn(*prev);
+
+        graph.addTask(task);
+        prev = task;
+    }
+
+    graph.execute();
+
+    ASSERT_EQ(log.order.size(), 10000u);
+    EXPECT_TRUE(is_sorted(log.order.begin(), log.order.end()));
+}
+
+TEST(TaskGraphTest, CycleIsRejectedBeforeRunning)
+{
+    RunLog log;
+    TaskGraph graph(2);
+
+    auto a = make_shared<Task<void>>(logNode(log, 1));
+    auto b = make_shared<Task<void>>(logNode(log, 2));
+    a->dependsOn(*b);
+    b->dependsOn(*a);
+    graph.addTask(a);
+    graph.addTask(b);
+
+    EXPECT_THROW(graph.execute(), logic_error);
+    EXPECT_TRUE(log.order.empty());
+}
+
+TEST(TaskGraphTest, TaskExceptionIsRethrown)
+{
+    TaskGraph graph(2);
+    auto failing = make_shared<Task<void>>(wrapAsTask([]
+                                                      { throw runtime_error("node failed"); }));
+    graph.addTask(failing);
+
+    EXPECT_THROW(graph.execute(), runtime_error);
+}
+
+TEST(TaskGraphTest, CompileBuildsCsrLayout)
+{
+    RunLog log;
+    TaskGraph graph(1);
+
+    // 0 -> {1, 2}, external -> 2
+    auto a = make_shared<Task<void>>(logNode(log, 0));
+    auto b = make_shared<Task<void>>(logNode(log, 1));
+    auto c = make_shared<Task<void>>(logNode(log, 2));
+    Task<void> external = logNode(log, 99);
+    b->dependsOn(*a);
+    c->dependsOn(*a);
+    c->dependsOn(external);
+
+    graph.addTask(a);
+    graph.addTask(b);
+    graph.addTask(c);
+
+    GraphLayout layout = graph.compile();
+
+    ASSERT_EQ(layout.size(), 3u);
+    EXPECT_EQ(layout.indegree, (vector<uint32_t>{0, 1, 1}));
+
+    auto succ = layout.successors_of(0);
+    EXPECT_EQ(vector<uint32_t>(succ.begin(), succ.end()), (vector<uint32_t>{1, 2}));
+    EXPECT_TRUE(layout.successors_of(1).empty());
+
+    auto pred = layout.predecessors_of(2);
+    EXPECT_EQ(vector<uint32_t>(pred.begin(), pred.end()), (vector<uint32_t>{0}));
+}
+
+static Task<void> countLeaves(atomic<int> &leaves, int depth)
+{
+    if (depth == 0)
+    {
+        leaves.fetch_add(1);
+        co_return;
+    }
+
+    // Split in two and let the join wait for both halves
+    Spawner spawner = co_await TaskGraph::spawner();
+    spawner.spawn(countLeaves(leaves, depth - 1));
+    spawner.spawn(countLeaves(leaves, depth - 1));
+}
+
+TEST(TaskGraphTest, SpawnedTasksJoinBeforeSuccessors)
+{
+    atomic<int> leaves{0};
+    int seenBySink = -1;
+    TaskGraph graph(1);
+
+    auto root = make_shared<Task<void>>(countLeaves(leaves, 10));
+    auto sink = make_shared<Task<void>>([](atomic<int> &leaves, int &seen) -> Task<void>
+                                        {
+        seen = leaves.load();
+        co_return; }(leaves, seenBySink));
+    sink->dependsOn(*root);
+
+    graph.addTask(root);
+    graph.addTask(sink);
+
+    WorkStealingThreadPool pool(4);
+    graph.execute(pool);
+
+    EXPECT_EQ(leaves.load(), 1024);
+    EXPECT_EQ(seenBySink, 1024);
+}
+
+static Task<void> spawnSubgraph(RunLog &log)
+{
+    // Diamond 10 -> {11, 12} -> 13, discovered at runtime
+    auto sub = make_shared<TaskGraph>(1);
+    auto a = make_shared<Task<void>>(logNode(log, 10));
+    auto b = make_shared<Task<void>>(logNode(log, 11));
+    auto c = make_shared<Task<void>>(logNode(log, 12));
+    auto d = make_shared<Task<void>>(logNode(log, 13));
+    b->dependsOn(*a);
+    c->dependsOn(*a);
+    d->dependsOn(*b);
+    d->dependsOn(*c);
+    sub->addTask(a);
+    sub->addTask(b);
+    sub->addTask(c);
+    sub->addTask(d);
+
+    Spawner spawner = co_await TaskGraph::spawner();
+    spawner.spawn(std::move(sub));
+    log.add(1);
+}
+
+TEST(TaskGraphTest, SpawnedSubgraphRunsInsideParent)
+{
+    RunLog log;
+    TaskGraph graph(1);
+
+    auto parent = make_shared<Task<void>>(spawnSubgraph(log));
+    auto after = make_shared<Task<void>>(logNode(log, 2));
+    after->dependsOn(*parent);
+    graph.addTask(parent);
+    graph.addTask(after);
+
+    WorkStealingThreadPool pool(3);
+    graph.execute(pool);
+
+    ASSERT_EQ(log.order.size(), 6u);
+    EXPECT_LT(log.positionOf(10), log.positionOf(11));
+    EXPECT_LT(log.positionOf(11), log.positionOf(13));
+    EXPECT_LT(log.positionOf(12), log.positionOf(13));
+    EXPECT_EQ(log.order.back(), 2);
+}
+
+// A node that runs a whole graph on the pool it is running on, and blocks on it
+TEST(TaskGraphTest, NestedGraphOnSameWorkerDoesNotDeadlock)
+{
+    RunLog log;
+    WorkStealingThreadPool pool(1);
+
+    TaskGraph inner(1);
+    auto x = make_shared<Task<void>>(logNode(log, 10));
+    auto y = make_shared<Task<void>>(logNode(log, 11));
+    y->dependsOn(*x);
+    inner.addTask(x);
+    inner.addTask(y);
+
+    TaskGraph outer(1);
+    auto nested = make_shared<Task<void>>(wrapAsTask([&]
+                                                     { inner.execute(pool); }));
+    auto after = make_shared<Task<void>>(logNode(log, 2));
+    after->dependsOn(*nested);
+    outer.addTask(nested);
+    outer.addTask(after);
+
+    outer.execute(pool);
+
+    EXPECT_EQ(log.order, (vector<int>{10, 11, 2}));
+}
+
+static Task<void> failingChild()
+{
+    throw runtime_error("child failed");
+    co_return;
+}
+
+static Task<void> spawnFailing()
+{
+    Spawner spawner = co_await TaskGraph::spawner();
+    spawner.spawn(failingChild());
+}
+
+TEST(TaskGraphTest, SpawnedExceptionIsRethrown)
+{
+    TaskGraph graph(1);
+    graph.addTask(make_shared<Task<void>>(spawnFailing()));
+
+    WorkStealingThreadPool pool(2);
+    EXPECT_THROW(graph.execute(pool), runtime_error);
+}
+
+TEST(TaskGraphTest, SpawnerOutsideGraphThrows)
+{
+    auto outside = []() -> Task<void>
+    {
+        Spawner spawner = co_await TaskGraph::spawner();
+        (void)spawner;
+    };
+
+    Task<void> task = outside();
+    EXPECT_THROW(task.get(), logic_error);
+}
+
+TEST(TaskGraphTest, DeepChainValidatesWithoutRecursion)
+{
+    RunLog log;
+    TaskGraph graph(1);
+    shared_ptr<Task<void>> prev;
+
+    for (int i = 0; i < 200000; ++i)
+    {
+        auto task = make_shared<Task<void>>(logNode(log, i));
+        if (prev)
+            task->dependsOn(*prev);
+
+        graph.addTask(task);
+        prev = std::move(task);
+    }
+
+    EXPECT_FALSE(graph.has_cycle());
+}
+
+TEST(TaskGraphTest, CycleIsReportedInDependencyOrder)
+{
+    RunLog log;
+    TaskGraph graph(1);
+
+    // 0 -> 1 -> 2 -> 3 -> 1, plus an unrelated component 4 -> 5
+    vector<shared_ptr<Task<void>>> tasks;
+    for (int i = 0; i < 6; ++i)
+    {
+        tasks.push_back(make_shared<Task<void>>(logNode(log, i)));
+        graph.addTask(tasks.back());
+    }
+    tasks[1]->dependsOn(*tasks[0]);
+    tasks[2]->dependsOn(*tasks[1]);
+    tasks[3]->dependsOn(*tasks[2]);
+    tasks[1]->dependsOn(*tasks[3]);
+    tasks[5]->dependsOn(*tasks[4]);
+
+    vector<uint32_t> cycle = graph.find_cycle();
+    ASSERT_EQ(cycle.size(), 3u);
+
+    // Rotate so the cycle starts at node 1
+    rotate(cycle.begin(), find(cycle.begin(), cycle.end(), 1u), cycle.end());
+    EXPECT_EQ(cycle, (vector<uint32_t>{1, 2, 3}));
+
+    // Same answer when every component is checked on its own
+    EXPECT_EQ(find_cycle(graph.compile(), 0).size(), 3u);
+
+    try
+    {
+        graph.execute();
+        FAIL() << "expected GraphCycleError";
+    }
+    catch (const GraphCycleError &e)
+    {
+        EXPECT_EQ(e.cycle.size(), 3u);
+    }
+
+    EXPECT_TRUE(log.order.empty());
+}
+
+TEST(TaskGraphTest, MaxLevelWidthCountsWidestLevel)
+{
+    RunLog log;
+    TaskGraph graph(1);
+
+    // 0 -> {1, 2, 3} -> 4, and 5 -> 4
+    vector<shared_ptr<Task<void>>> tasks;
+    for (int i = 0; i < 6; ++i)
+    {
+        tasks.push_back(make_shared<Task<void>>(logNode(log, i)));
+        graph.addTask(tasks.back());
+    }
+    for (int i = 1; i <= 3; ++i)
+    {
+        tasks[i]->dependsOn(*tasks[0]);
+        tasks[4]->dependsOn(*tasks[i]);
+    }
+    tasks[4]->dependsOn(*tasks[5]);
+
+    EXPECT_EQ(max_level_width(graph.compile()), 3u);
+}
+
+TEST(TaskGraphTest, AdaptivePoolPersistsAcrossRuns)
+{
+    RunLog log;
+    AdaptiveTaskGraph graph(8);
+
+    auto chain = [&](int base)
+    {
+        graph.tasks.clear();
+        shared_ptr<Task<void>> prev;
+        for (int i = 0; i < 3; ++i)
+        {
+            auto task = make_shared<Task<void>>(logNode(log, base + i));
+            if (prev)
+                task->dependsOn(*prev);
+            graph.addTask(task);
+            prev = task;
+        }
+    };
+
+    // A chain has width 1: one worker is enough, and the same pool serves the next run
+    chain(0);
+    graph.execute();
+    EXPECT_EQ(graph.threads(), 1u);
+    WorkStealingThreadPool *first = graph.pool.get();
+
+    chain(10);
+    graph.execute();
+    EXPECT_EQ(graph.pool.get(), first);
+    EXPECT_EQ(log.order, (vector<int>{0, 1, 2, 10, 11, 12}));
+}
+
+TEST(TaskGraphTest, LocalityKeepsChainsAndFanInTogether)
+{
+    RunLog log;
+    TaskGraph graph(2);
+
+    // Chains 0 -> 1 -> 2 and 3 -> 4 -> 5, then 6 joins {1, 2, 5}
+    vector<shared_ptr<Task<void>>> tasks;
+    for (int i = 0; i < 7; ++i)
+    {
+        tasks.push_back(make_shared<Task<void>>(logNode(log, i)));
+        graph.addTask(tasks.back());
+    }
+    tasks[1]->dependsOn(*tasks[0]);
+    tasks[2]->dependsOn(*tasks[1]);
+    tasks[4]->dependsOn(*tasks[3]);
+    tasks[5]->dependsOn(*tasks[4]);
+    tasks[6]->dependsOn(*tasks[1]);
+    tasks[6]->dependsOn(*tasks[2]);
+    tasks[6]->dependsOn(*tasks[5]);
+
+    vector<uint32_t> home = partition_for_locality(graph.compile(), 2);
+
+    EXPECT_EQ(home[0], home[1]);
+    EXPECT_EQ(home[1], home[2]);
+    EXPECT_EQ(home[3], home[4]);
+    EXPECT_EQ(home[4], home[5]);
+    EXPECT_NE(home[0], home[3]); // Two chains, two workers
+    EXPECT_EQ(home[6], home[0]); // Most of the fan-in comes from the first chain
+
+    WorkStealingThreadPool pool(2);
+    graph.execute(pool);
+
+    EXPECT_EQ(log.order.size(), 7u);
+    EXPECT_EQ(graph.last_run.nodes, 7u);
+    EXPECT_EQ(graph.last_run.edges, 7u);
+}
+
+// Node `level` of a chain runs only alongside the same level of the other chain
+static Task<void> lockstepNode(atomic<int> *started, int level)
+{
+    started[level].fetch_add(1);
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(10);
+    while (started[level].load() < 2 && chrono::steady_clock::now() < deadline)
+        this_thread::yield();
+    co_return;
+}
+
+// Two independent chains kept busy in lockstep: no worker is ever idle to steal, so none crosses
+TEST(TaskGraphTest, LocalityKeepsIndependentChainsOnTheirWorkers)
+{
+    constexpr int length = 50;
+    atomic<int> started[length] = {};
+    TaskGraph graph(2);
+
+    for (int chain = 0; chain < 2; ++chain)
+    {
+        shared_ptr<Task<void>> previous;
+        for (int level = 0; level < length; ++level)
+        {
+            auto task = make_shared<Task<void>>(lockstepNode(started, level));
+            if (previous)
+                task->dependsOn(*previous);
+            graph.addTask(task);
+            previous = task;
+        }
+    }
+
+    WorkStealingThreadPool pool(2);
+    graph.execute(pool);
+
+    for (int level = 0; level < length; ++level)
+        EXPECT_EQ(started[level].load(), 2);
+    EXPECT_EQ(graph.last_run.edges, 2u * (length - 1));
+    EXPECT_EQ(graph.last_run.cross_worker_edges, 0u);
+}
+
+// Tiny memoized pipeline: source -> doubled -> sum, outputs kept in plain ints
+struct MemoPipeline
+{
+    int input = 0;
+    int source = 0, doubled = 0, sum = 0;
+    int runs = 0;
+
+    TaskGraph graph{1};
+
+    static Task<void> step(int &runs, function<void()> body)
+    {
+        ++runs;
+        body();
+        co_return;
+    }
+
+    void build(shared_ptr<ArtifactCache> cache)
+    {
+        graph.tasks.clear();
+        graph.memo.clear();
+        graph.cache = std::move(cache);
+
+        auto a = make_shared<Task<void>>(step(runs, [this]
+                                              { source = input; }));
+        auto b = make_shared<Task<void>>(step(runs, [this]
+                                              { doubled = source * 2; }));
+        auto c = make_shared<Task<void>>(step(runs, [this]
+                                              { sum = doubled + 1; }));
+        b->dependsOn(*a);
+        c->dependsOn(*b);
+        graph.addTask(a);
+        graph.addTask(b);
+        graph.addTask(c);
+
+        auto spec = [](int &slot, uint64_t fingerprint)
+        {
+            return MemoSpec{fingerprint, [&slot]
+                            { return to_string(slot); },
+                            [&slot](const string &bytes)
+                            { slot = stoi(bytes); }};
+        };
+        graph.memoize(*a, spec(source, static_cast<uint64_t>(input)));
+        graph.memoize(*b, spec(doubled, 1));
+        graph.memoize(*c, spec(sum, 2));
+    }
+};
+
+TEST(TaskGraphTest, MemoizedNodesAreSkippedWhenInputsAreUnchanged)
+{
+    auto cache = make_shared<ArtifactCache>();
+    WorkStealingThreadPool pool(2);
+    MemoPipeline p;
+
+    p.input = 5;
+    p.build(cache);
+    p.graph.execute(pool);
+    EXPECT_EQ(p.sum, 11);
+    EXPECT_EQ(p.runs, 3);
+    EXPECT_EQ(p.graph.last_run.cache_misses, 3u);
+
+    // Same inputs: nothing runs, only the sink's output is restored
+    p.sum = 0;
+    p.build(cache);
+    p.graph.execute(pool);
+    EXPECT_EQ(p.runs, 3);
+    EXPECT_EQ(p.sum, 11);
+    EXPECT_EQ(p.graph.last_run.cache_hits, 3u);
+    EXPECT_NE(p.graph.last_run.summary().find("100% hit rate"), string::npos);
+
+    // New input: the change flows through every downstream key
+    p.input = 7;
+    p.build(cache);
+    p.graph.execute(pool);
+    EXPECT_EQ(p.runs, 6);
+    EXPECT_EQ(p.sum, 15);
+}
+
+// An output needed by the run is fetched when planning, before other nodes' stores can evict it
+TEST(TaskGraphTest, MemoizedOutputSurvivesEvictionDuringTheRun)
+{
+    // big -> source -> doubled -> sum, where sum is not memoized and always runs
+    string big;
+    int source = 0, doubled = 0, sum = 0;
+    int runs = 0;
+    const size_t bigSize = 64;
+
+    // Room for every artifact of one run, and no more
+    auto cache = make_shared<ArtifactCache>(bigSize + 3);
+    WorkStealingThreadPool pool(2);
+    TaskGraph graph(1);
+
+    auto build = [&]
+    {
+        graph.tasks.clear();
+        graph.memo.clear();
+        graph.cache = cache;
+
+        auto d = make_shared<Task<void>>(MemoPipeline::step(runs, [&]
+                                                            { big.assign(bigSize, 'x'); }));
+        auto a = make_shared<Task<void>>(MemoPipeline::step(runs, [&]
+                                                            { source = 5; }));
+        auto b = make_shared<Task<void>>(MemoPipeline::step(runs, [&]
+                                                            { doubled = source * 2; }));
+        auto c = make_shared<Task<void>>(MemoPipeline::step(runs, [&]
+                                                            { sum = doubled + 1; }));
+        a->dependsOn(*d);
+        b->dependsOn(*a);
+        c->dependsOn(*b);
+        for (auto &task : {d, a, b, c})
+            graph.addTask(task);
+
+        graph.memoize(*d, MemoSpec{1, [&]
+                                   { return big; },
+                                   [&](const string &bytes)
+                                   { big = bytes; }});
+        graph.memoize(*a, MemoSpec{2, [&]
+                                   { return to_string(source); },
+                                   [&](const string &bytes)
+                                   { source = stoi(bytes); }});
+        graph.memoize(*b, MemoSpec{3, [&]
+                                   { return to_string(doubled); },
+                                   [&](const string &bytes)
+                                   { doubled = stoi(bytes); }});
+    };
+
+    build();
+    graph.execute(pool);
+    EXPECT_EQ(sum, 11);
+    EXPECT_EQ(runs, 4);
+
+    // Evicts only the big artifact: the next run stores it again, which evicts the two small ones
+    cache->put(0, string(bigSize, 'y'));
+
+    source = doubled = sum = 0;
+    build();
+    graph.execute(pool);
+    EXPECT_EQ(runs, 6); // big and sum
+    EXPECT_EQ(source, 0); // Skipped and not needed
+    EXPECT_EQ(doubled, 10);
+    EXPECT_EQ(sum, 11);
+}
+
+TEST(TaskGraphTest, ArtifactCacheEvictsAndFallsBackToDisk)
+{
+    auto dir = filesystem::temp_directory_path() / "task_graph_artifact_cache_test";
+    filesystem::remove_all(dir);
+
+    ArtifactCache cache(8, dir);
+    cache.put(1, "aaaa");
+    cache.put(2, "bbbb");
+    cache.put(3, "cccc"); // Evicts key 1 from memory
+
+    EXPECT_LE(cache.memoryUsed(), 8u);
+    EXPECT_EQ(cache.get(1).value_or(""), "aaaa"); // From disk
+    EXPECT_EQ(cache.get(3).value_or(""), "cccc");
+    EXPECT_FALSE(cache.get(4).has_value());
+    EXPECT_EQ(cache.misses(), 1u);
+
+    filesystem::remove_all(dir);
+}
@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+#include "../src/JobDispatcher.hh"
+#include "../src/TaskGroup.hh"
+
+#include <algorithm>
+#include <future>
+#include <numeric>
+#include <random>
+#include <set>
+#include <stdexcept>
+
+// Run `body` as a job on worker 0 and wait for it, at most 10s
+template <typename F>
+static void runOnDispatcher(JobDispatcher &dispatcher, F body)
+{
+    promise<void> done;
+    auto job = make_unique<Job>();
+    job->tasks = [&]()
+    {
+        try
+        {
+            body();
+            done.set_value();
+        }
+        catch (...)
+        {
+            done.set_exception(current_exception());
+        }
+    };
+
+    future<void> finished = done.get_future();
+    dispatcher.dispatch(0, std::move(job));
+    ASSERT_EQ(finished.wait_for(chrono::seconds(10)), future_status::ready);
+    finished.get();
+}
+
+static long long parallelFib(int n)
+{
+    if (n < 12)
+    {
+        long long a = 0, b = 1;
+        for (int i = 0; i < n; ++i)
+            a = exchange(b, a + b);
+        return a;
+    }
+
+    long long left = 0;
+    TaskGroup group;
+    group.spawn([&]
+                { left = parallelFib(n - 1); });
+    long long right = parallelFib(n - 2);
+    group.sync();
+
+    return left + right;
+}
+
+static void parallelQuickSort(int *first, int *last)
+{
+    if (last - first < 256)
+    {
+        sort(first, last);
+        return;
+    }
+
+    int pivot = first[(last - first) / 2];
+    int *middle1 = partition(first, last, [pivot](int x)
+                             { return x < pivot; });
+    int *middle2 = partition(middle1, last, [pivot](int x)
+                             { return !(pivot < x); });
+
+    TaskGroup group;
+    group.spawn([=]
+                { parallelQuickSort(first, middle1); });
+    parallelQuickSort(middle2, last);
+    group.sync();
+}
+
+TEST(TaskGroupTest, RecursiveFibOnWorkers)
+{
+    JobDispatcher dispatcher(4);
+
+    long long result = 0;
+    runOnDispatcher(dispatcher, [&]
+                    { result = parallelFib(25); });
+    dispatcher.stop();
+
+    EXPECT_EQ(result, 75025);
+}
+
+// One worker: every sync has to run its own strands, nothing may block
+TEST(TaskGroupTest, SingleWorkerDoesNotDeadlock)
+{
+    JobDispatcher dispatcher(1);
+
+    long long result = 0;
+    runOnDispatcher(dispatcher, [&]
+                    { result = parallelFib(22); });
+    dispatcher.stop();
+
+    EXPECT_EQ(result, 17711);
+}
+
+TEST(TaskGroupTest, ParallelQuickSort)
+{
+    vector<int> values(200000);
+    mt19937 rng(7);
+    for (int &v : values)
+        v = static_cast<int>(rng() % 10000);
+
+    vector<int> expected = values;
+    sort(expected.begin(), expected.end());
+
+    JobDispatcher dispatcher(4);
+    runOnDispatcher(dispatcher, [&]
+                    { parallelQuickSort(values.data(), values.data() + values.size()); });
+    dispatcher.stop();
+
+    EXPECT_EQ(values, expected);
+}
+
+TEST(TaskGroupTest, StrandsAreStolenByIdleWorkers)
+{
+    JobDispatcher dispatcher(4);
+
+    mutex mtx;
+    set<thread::id> threads;
+    runOnDispatcher(dispatcher, [&]
+                    {
+        TaskGroup group;
+        for (int i = 0; i < 64; ++i)
+            group.spawn([&]
+                        {
+                this_thread::sleep_for(chrono::milliseconds(5));
+                lock_guard lock(mtx);
+                threads.insert(this_thread::get_id()); });
+        group.sync(); });
+    dispatcher.stop();
+
+    EXPECT_GE(threads.size(), 2u);
+}
+
+TEST(TaskGroupTest, SyncRethrowsFirstStrandException)
+{
+    JobDispatcher dispatcher(2);
+
+    atomic<int> completed{0};
+    bool caught = false;
+    runOnDispatcher(dispatcher, [&]
+                    {
+        TaskGroup group;
+        for (int i = 0; i < 8; ++i)
+            group.spawn([&, i]
+                        {
+                if (i == 3)
+                    throw runtime_error("strand failed");
+                completed.fetch_add(1); });
+
+        try
+        {
+            group.sync();
+        }
+        catch (const runtime_error &e)
+        {
+            caught = string(e.what()) == "strand failed";
+        }
+
+        EXPECT_EQ(group.pendingCount(), 0u);
+        group.sync(); // The error was consumed
+    });
+    dispatcher.stop();
+
+    EXPECT_TRUE(caught);
+    EXPECT_EQ(completed.load(), 7);
+}
+
+// Off the workers spawn() runs inline and sync() only reports errors
+TEST(TaskGroupTest, SerialElisionOffWorkers)
+{
+    vector<int> order;
+    TaskGroup group;
+    group.spawn([&]
+                { order.push_back(1); });
+    order.push_back(2);
+    group.spawn([]
+                { throw logic_error("inline"); });
+
+    EXPECT_EQ(group.pendingCount(), 0u);
+    EXPECT_THROW(group.sync(), logic_error);
+    EXPECT_EQ(order, (vector<int>{1, 2}));
+}
+
+// Two dispatchers used to share one static list of queues
+TEST(TaskGroupTest, DispatchersStealOnlyFromTheirOwnQueues)
+{
+    atomic<int> counter{0};
+    {
+        JobDispatcher first(2);
+        first.stop();
+    }
+
+    JobDispatcher second(2);
+    runOnDispatcher(second, [&]
+                    {
+        TaskGroup group;
+        for (int i = 0; i < 100; ++i)
+            group.spawn([&]
+                        { counter.fetch_add(1); });
+        group.sync(); });
+    second.stop();
+
+    EXPECT_EQ(counter.load(), 100);
+}
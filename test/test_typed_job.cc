@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+#include "../src/JobBuilder.hh"
+#include "../src/JobDispatcher.hh"
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+TEST(TypedJobTest, CallbacksAndRetries)
+{
+    int calls = 0;
+    vector<string> events;
+    JobResult seen;
+
+    auto job = JobBuilder::typed()
+                   .withId("typed")
+                   .withCategory("io")
+                   .withRetry(2)
+                   .onStart([&]
+                            { events.push_back("start"); })
+                   .onError([&](const string &error)
+                            { events.push_back(error); })
+                   .onResult([&](const JobResult &result)
+                             { seen = result; })
+                   .onComplete([&](bool success, int attempts, long long)
+                               { events.push_back(success ? "ok " + to_string(attempts) : "failed"); })
+                   .build([&]
+                          {
+                              if (++calls < 3)
+                                  throw runtime_error("boom");
+                          });
+
+    EXPECT_TRUE(job.run());
+    EXPECT_EQ(calls, 3);
+    EXPECT_EQ(events, (vector<string>{"start", "boom", "boom", "ok 3"}));
+    EXPECT_TRUE(seen.success);
+    EXPECT_EQ(seen.attempts, 3);
+    EXPECT_EQ(seen.jobId, "typed");
+    EXPECT_EQ(seen.category, CategoryName("io"));
+    EXPECT_FALSE(seen.errorMessage.has_value());
+}
+
+TEST(TypedJobTest, FailureReportsLastError)
+{
+    optional<JobResult> seen;
+    auto job = JobBuilder::typed()
+                   .onResult([&](const JobResult &result)
+                             { seen = result; })
+                   .build([]
+                          { throw runtime_error("always"); });
+
+    EXPECT_FALSE(job.run());
+    ASSERT_TRUE(seen.has_value());
+    EXPECT_FALSE(seen->success);
+    EXPECT_EQ(seen->attempts, 1);
+    EXPECT_EQ(seen->errorMessage, "always");
+}
+
+// Callbacks not given take no room: a bare job is its task, its id and its category
+TEST(TypedJobTest, UnusedPoliciesTakeNoRoom)
+{
+    int *counter = nullptr;
+    auto bare = JobBuilder::typed().build([counter]
+                                          { ++*counter; });
+    struct Fields
+    {
+        int *task;
+        string id;
+        CategoryName category;
+    };
+    EXPECT_EQ(sizeof(bare), sizeof(Fields));
+    EXPECT_FALSE(decltype(bare)::timed);
+
+    auto onComplete = JobBuilder::typed()
+                          .onComplete([](bool, int, long long) {})
+                          .build([counter]
+                                 { ++*counter; });
+    EXPECT_EQ(sizeof(onComplete), sizeof(bare));
+    EXPECT_TRUE(decltype(onComplete)::timed);
+}
+
+// One builder stamps many jobs, each with its own copy of the callbacks
+TEST(TypedJobTest, BuilderStampsManyJobs)
+{
+    int completed = 0;
+    auto builder = JobBuilder::typed().onComplete([&](bool success, int, long long)
+                                                  { completed += success; });
+
+    for (int i = 0; i < 3; ++i)
+        builder.build([] {}).run();
+
+    EXPECT_EQ(completed, 3);
+}
+
+// Erased for dispatch, a job with an id and callbacks is one pooled node: no allocation outside JobPool
+TEST(TypedJobTest, ErasedIntoOnePooledNode)
+{
+    atomic<int> events{0};
+    string lastId;
+
+    auto builder = JobBuilder::typed()
+                       .withId("pooled")
+                       .withRetry(1)
+                       .onStart([&]
+                                { events.fetch_add(1); })
+                       .onResult([&](const JobResult &result)
+                                 { lastId = result.jobId; })
+                       .onComplete([&](bool success, int, long long)
+                                   { events.fetch_add(success); });
+    auto task = [&]
+    { events.fetch_add(1); };
+
+    static_assert(decltype(builder.build(task))::pooled(), "a typed job with callbacks should fit one JobPool block");
+
+    unique_ptr<Job> first = builder.build(task).toJob();
+    EXPECT_TRUE(first->spawned);
+    first->tasks();
+    EXPECT_EQ(events.load(), 3);
+    EXPECT_EQ(lastId, "pooled");
+
+    // Released on this thread, the node's block is reused by the next one
+    Job *storage = first.get();
+    first.reset();
+    unique_ptr<Job> second = builder.build(task).toJob();
+    EXPECT_EQ(second.get(), storage);
+}
+
+TEST(TypedJobTest, DispatchedThroughJobDispatcher)
+{
+    constexpr int count = 1000;
+    atomic<int> ran{0}, completed{0};
+    promise<void> done;
+    future<void> finished = done.get_future();
+
+    JobDispatcher dispatcher(2);
+    auto builder = JobBuilder::typed().onComplete([&](bool success, int, long long)
+                                                  {
+                                                      if (success && completed.fetch_add(1) + 1 == count)
+                                                          done.set_value(); });
+
+    for (int i = 0; i < count; ++i)
+        dispatcher.dispatch(i % 2, builder.build([&]
+                                                 { ran.fetch_add(1); }));
+
+    ASSERT_EQ(finished.wait_for(chrono::seconds(10)), future_status::ready);
+    dispatcher.stop();
+    EXPECT_EQ(ran.load(), count);
+}
+
+// The returned value is moved through: a move-only type arrives intact
+TEST(TypedJobTest, ValueMovedToOnValue)
+{
+    optional<JobResultOf<unique_ptr<int>>> seen;
+    auto job = JobBuilder::typed()
+                   .withId("answer")
+                   .onValue([&](JobResultOf<unique_ptr<int>> &&result)
+                            { seen = std::move(result); })
+                   .build([]
+                          { return make_unique<int>(42); });
+
+    EXPECT_TRUE(job.run());
+    ASSERT_TRUE(seen.has_value());
+    EXPECT_TRUE(seen->success);
+    EXPECT_EQ(seen->jobId, "answer");
+    ASSERT_TRUE(seen->value.has_value());
+    EXPECT_EQ(**seen->value, 42);
+}
+
+TEST(TypedJobTest, FailedJobHasNoValue)
+{
+    optional<JobResultOf<int>> seen;
+    auto job = JobBuilder::typed()
+                   .withRetry(1)
+                   .onValue([&](JobResultOf<int> &&result)
+                            { seen = std::move(result); })
+                   .build([]() -> int
+                          { throw runtime_error("no value"); });
+
+    EXPECT_FALSE(job.run());
+    ASSERT_TRUE(seen.has_value());
+    EXPECT_FALSE(seen->success);
+    EXPECT_EQ(seen->attempts, 2);
+    EXPECT_FALSE(seen->value.has_value());
+    EXPECT_EQ(seen->errorMessage, "no value");
+}
+
+// Values come back through handles and are aggregated after completion
+TEST(TypedJobTest, SubmitReturnsHandles)
+{
+    JobDispatcher dispatcher(2);
+    vector<JobHandle<int>> handles;
+    for (int i = 0; i < 100; ++i)
+        handles.push_back(dispatcher.submit(i % 2, JobBuilder::typed().build([i]
+                                                                              { return i * i; })));
+
+    JobHandle<void> last = dispatcher.submit(0, JobBuilder::typed().build([] {}));
+
+    int sum = 0;
+    for (JobHandle<int> &handle : handles)
+    {
+        JobResultOf<int> result = handle.get();
+        ASSERT_TRUE(result.success);
+        sum += *result.value;
+    }
+
+    last.wait();
+    EXPECT_TRUE(last.ready());
+    EXPECT_TRUE(last.get().success);
+    dispatcher.stop();
+
+    EXPECT_EQ(sum, 328350);
+}
+
+TEST(TypedJobTest, DroppedJobResolvesItsHandle)
+{
+    JobPromise<int> promise;
+    JobHandle<int> handle = promise.handle();
+    {
+        auto job = JobBuilder::typed().build([]
+                                             { return 1; })
+                       .with(OnValue<JobPromise<int>>{std::move(promise)});
+    }
+
+    ASSERT_TRUE(handle.ready());
+    JobResultOf<int> result = handle.get();
+    EXPECT_FALSE(result.success);
+    EXPECT_FALSE(result.value.has_value());
+    EXPECT_TRUE(result.errorMessage.has_value());
+}
@@ -15,13 +15,13 @@ TEST(WorkerTest, SingleJobExecuted)
     atomic<bool> onResultCalled = false;
 
     Job job;
-    job.id = "test-job";
+    job.editDetails().id = "test-job";
     job.tasks = [&]()
     {
         this_thread::sleep_for(chrono::milliseconds(50));
         jobExecuted = true;
     };
-    job.onResult = [&](const JobResult &)
+    job.editDetails().onResult = [&](const JobResult &)
     {
         onResultCalled = true;
     };
@@ -55,7 +55,7 @@ TEST(WorkerTest, JobStealWorks)
     for (int i = 0; i < 5; ++i)
     {
         Job job;
-        job.id = "job" + to_string(i);
+        job.editDetails().id = "job" + to_string(i);
         job.tasks = [&count]()
         {
             this_thread::sleep_for(chrono::milliseconds(10));
@@ -94,7 +94,7 @@ TEST(WorkerTest, SingleJobExecutedWithAllCallbacks)
     atomic<bool> onStartCalled = false;
 
     Job job;
-    job.id = "test-job";
+    job.editDetails().id = "test-job";
     job.retryCount = 0; // No retry needed
     job.tasks = [&]()
     {
@@ -102,17 +102,17 @@ TEST(WorkerTest, SingleJobExecutedWithAllCallbacks)
         jobExecuted = true;
     };
 
-    job.onStart = [&]()
+    job.editDetails().onStart = [&]()
     {
         onStartCalled = true;
     };
 
-    job.onResult = [&](const JobResult &)
+    job.editDetails().onResult = [&](const JobResult &)
     {
         onResultCalled = true;
     };
 
-    job.onComplete = [&](bool success, int attempt, long long durationMs)
+    job.editDetails().onComplete = [&](bool success, int attempt, long long durationMs)
     {
         onCompleteCalled = true;
         EXPECT_TRUE(success);
@@ -120,7 +120,7 @@ TEST(WorkerTest, SingleJobExecutedWithAllCallbacks)
         EXPECT_GE(durationMs, 50);
     };
 
-    job.onAttempt = [&](int attempt, bool success, long long elapsed, string_view errorMsg)
+    job.editDetails().onAttempt = [&](int attempt, bool success, long long elapsed, string_view errorMsg)
     {
         onAttemptCalled = true;
         EXPECT_TRUE(success);
@@ -159,25 +159,25 @@ TEST(WorkerTest, JobStealWithCallbacks)
     for (int i = 0; i < 5; ++i)
     {
         Job job;
-        job.id = "job" + to_string(i);
+        job.editDetails().id = "job" + to_string(i);
         job.tasks = [&]()
         {
             this_thread::sleep_for(chrono::milliseconds(20));
             executedCount.fetch_add(1);
         };
 
-        job.onResult = [&](const JobResult &)
+        job.editDetails().onResult = [&](const JobResult &)
         {
             onResultCount.fetch_add(1);
         };
 
-        job.onAttempt = [&](int attempt, bool success, long long elapsed, string_view errorMsg)
+        job.editDetails().onAttempt = [&](int attempt, bool success, long long elapsed, string_view errorMsg)
         {
             onAttemptCount.fetch_add(1);
             EXPECT_TRUE(success);
         };
 
-        job.onComplete = [&](bool success, int attempt, long long elapsed)
+        job.editDetails().onComplete = [&](bool success, int attempt, long long elapsed)
         {
             onCompleteCount.fetch_add(1);
         };
@@ -215,27 +215,27 @@ TEST(WorkerTest, JobErrorTriggersOnError)
     atomic<bool> onCompleteCalled = false;
 
     Job job;
-    job.id = "error-job";
+    job.editDetails().id = "error-job";
     job.tasks = []
     {
         throw std::runtime_error("intentional failure");
     };
     job.retryCount = 0;
 
-    job.onError = [&](const string &err)
+    job.editDetails().onError = [&](const string &err)
     {
         onErrorCalled = true;
         EXPECT_NE(err.find("intentional failure"), string::npos);
     };
 
-    job.onResult = [&](const JobResult &result)
+    job.editDetails().onResult = [&](const JobResult &result)
     {
         onResultCalled = true;
         EXPECT_FALSE(result.success);
         EXPECT_EQ(result.attempts, 1);
     };
 
-    job.onComplete = [&](bool success, int attempt, long long elapsed)
+    job.editDetails().onComplete = [&](bool success, int attempt, long long elapsed)
     {
         onCompleteCalled = true;
         EXPECT_FALSE(success);
@@ -266,25 +266,25 @@ TEST(WorkerTest, JobTimeoutTriggersOnTimeout)
     atomic<bool> onResultCalled = false;
 
     Job job;
-    job.id = "timeout-job";
+    job.editDetails().id = "timeout-job";
     job.timeoutMs = 50;
     job.tasks = []
     {
         this_thread::sleep_for(chrono::milliseconds(200)); // quá timeout
     };
 
-    job.onTimeout = [&]()
+    job.editDetails().onTimeout = [&]()
     {
         onTimeoutCalled = true;
     };
 
-    job.onResult = [&](const JobResult &result)
+    job.editDetails().onResult = [&](const JobResult &result)
     {
         onResultCalled = true;
         EXPECT_FALSE(result.success);
     };
 
-    job.onComplete = [&](bool success, int attempt, long long elapsed)
+    job.editDetails().onComplete = [&](bool success, int attempt, long long elapsed)
     {
         onCompleteCalled = true;
         EXPECT_FALSE(success);
@@ -315,7 +315,7 @@ TEST(WorkerTest, JobRetriesOnFailure)
     atomic<bool> onResultCalled = false;
 
     Job job;
-    job.id = "retry-job";
+    job.editDetails().id = "retry-job";
     job.retryCount = 3;
 
     job.tasks = [&]()
@@ -325,7 +325,7 @@ TEST(WorkerTest, JobRetriesOnFailure)
         // succeed on third attempt
     };
 
-    job.onAttempt = [&](int attempt, bool success, long long elapsed, string_view errorMsg)
+    job.editDetails().onAttempt = [&](int attempt, bool success, long long elapsed, string_view errorMsg)
     {
         attemptCount.fetch_add(1);
         if (attempt < 3)
@@ -334,7 +334,7 @@ TEST(WorkerTest, JobRetriesOnFailure)
             EXPECT_TRUE(success);
     };
 
-    job.onResult = [&](const JobResult &result)
+    job.editDetails().onResult = [&](const JobResult &result)
     {
         onResultCalled = true;
         EXPECT_TRUE(result.success);